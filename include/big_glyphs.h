@@ -0,0 +1,114 @@
+#ifndef BIG_GLYPHS_H
+#define BIG_GLYPHS_H
+
+// Generated by tools/make_big_glyphs.py from the font in
+// src/page_display.cpp, rerun it rather than editing this file.
+
+#include <Arduino.h>
+
+#define BIG_GLYPH_WIDTH 15
+#define BIG_GLYPH_PAGES 3
+
+static const char bigGlyphCharacters[] PROGMEM = "0123456789AFLNORSTU";
+
+// One page of 15 columns after another, top page first
+static const uint8_t bigGlyphs[][BIG_GLYPH_PAGES * BIG_GLYPH_WIDTH] PROGMEM =
+{
+    {   // 0
+        0xF8, 0xF8, 0xF8, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xC7, 0xC7, 0xC7, 0xF8, 0xF8, 0xF8,
+        0xFF, 0xFF, 0xFF, 0x70, 0x70, 0x70, 0x0E, 0x0E, 0x0E, 0x01, 0x01, 0x01, 0xFF, 0xFF, 0xFF,
+        0x03, 0x03, 0x03, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x03, 0x03, 0x03
+    },
+    {   // 1
+        0x00, 0x00, 0x00, 0x38, 0x38, 0x38, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x1C, 0x1C, 0x1C, 0x1F, 0x1F, 0x1F, 0x1C, 0x1C, 0x1C, 0x00, 0x00, 0x00
+    },
+    {   // 2
+        0x38, 0x38, 0x38, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xF8, 0xF8, 0xF8,
+        0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x70, 0x70, 0x70, 0x0E, 0x0E, 0x0E, 0x01, 0x01, 0x01,
+        0x1C, 0x1C, 0x1C, 0x1F, 0x1F, 0x1F, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C
+    },
+    {   // 3
+        0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xC7, 0xC7, 0xC7, 0x3F, 0x3F, 0x3F, 0x07, 0x07, 0x07,
+        0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x0E, 0x0E, 0x0E, 0xF0, 0xF0, 0xF0,
+        0x03, 0x03, 0x03, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x03, 0x03, 0x03
+    },
+    {   // 4
+        0x00, 0x00, 0x00, 0xC0, 0xC0, 0xC0, 0x38, 0x38, 0x38, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00,
+        0x7E, 0x7E, 0x7E, 0x71, 0x71, 0x71, 0x70, 0x70, 0x70, 0xFF, 0xFF, 0xFF, 0x70, 0x70, 0x70,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00
+    },
+    {   // 5
+        0xFF, 0xFF, 0xFF, 0xC7, 0xC7, 0xC7, 0xC7, 0xC7, 0xC7, 0xC7, 0xC7, 0xC7, 0x07, 0x07, 0x07,
+        0x81, 0x81, 0x81, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFE, 0xFE, 0xFE,
+        0x03, 0x03, 0x03, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x03, 0x03, 0x03
+    },
+    {   // 6
+        0xC0, 0xC0, 0xC0, 0x38, 0x38, 0x38, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x00, 0x00, 0x00,
+        0xFF, 0xFF, 0xFF, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0xF0, 0xF0, 0xF0,
+        0x03, 0x03, 0x03, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x03, 0x03, 0x03
+    },
+    {   // 7
+        0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xC7, 0xC7, 0xC7, 0x3F, 0x3F, 0x3F,
+        0x00, 0x00, 0x00, 0xF0, 0xF0, 0xF0, 0x0E, 0x0E, 0x0E, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    {   // 8
+        0xF8, 0xF8, 0xF8, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xF8, 0xF8, 0xF8,
+        0xF1, 0xF1, 0xF1, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0xF1, 0xF1, 0xF1,
+        0x03, 0x03, 0x03, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x03, 0x03, 0x03
+    },
+    {   // 9
+        0xF8, 0xF8, 0xF8, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xF8, 0xF8, 0xF8,
+        0x01, 0x01, 0x01, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x8E, 0x8E, 0x8E, 0x7F, 0x7F, 0x7F,
+        0x00, 0x00, 0x00, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00
+    },
+    {   // A
+        0xF8, 0xF8, 0xF8, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xF8, 0xF8, 0xF8,
+        0xFF, 0xFF, 0xFF, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0xFF, 0xFF, 0xFF,
+        0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F
+    },
+    {   // F
+        0xFF, 0xFF, 0xFF, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07,
+        0xFF, 0xFF, 0xFF, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x00, 0x00, 0x00,
+        0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    {   // L
+        0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x1F, 0x1F, 0x1F, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C
+    },
+    {   // N
+        0xFF, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0x01, 0x01, 0x01, 0x0E, 0x0E, 0x0E, 0x70, 0x70, 0x70, 0xFF, 0xFF, 0xFF,
+        0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F
+    },
+    {   // O
+        0xF8, 0xF8, 0xF8, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xF8, 0xF8, 0xF8,
+        0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF,
+        0x03, 0x03, 0x03, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x03, 0x03, 0x03
+    },
+    {   // R
+        0xFF, 0xFF, 0xFF, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xF8, 0xF8, 0xF8,
+        0xFF, 0xFF, 0xFF, 0x0E, 0x0E, 0x0E, 0x7E, 0x7E, 0x7E, 0x8E, 0x8E, 0x8E, 0x01, 0x01, 0x01,
+        0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x03, 0x1C, 0x1C, 0x1C
+    },
+    {   // S
+        0xF8, 0xF8, 0xF8, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07,
+        0x01, 0x01, 0x01, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0xF0, 0xF0, 0xF0,
+        0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x03, 0x03, 0x03
+    },
+    {   // T
+        0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xFF, 0xFF, 0xFF, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    {   // U
+        0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF,
+        0x03, 0x03, 0x03, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x03, 0x03, 0x03
+    }
+};
+
+#endif
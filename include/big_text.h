@@ -0,0 +1,35 @@
+#ifndef BIG_TEXT_H
+#define BIG_TEXT_H
+
+#include "page_display.h"
+
+// Three times size text for the values and options, drawn from glyphs
+// pre-rendered in PROGMEM a page at a time. Text sits on page boundaries so
+// each glyph is three straight byte copies, no scaling or shifting.
+#define BIG_TEXT_ADVANCE 18     // Glyph plus the gap before the next one
+#define BIG_TEXT_GAP 3
+#define BIG_TEXT_HEIGHT 24
+
+constexpr int16_t bigTextLength(const char* text)
+{
+    return *text ? 1 + bigTextLength(text + 1) : 0;
+}
+
+// Width of the text in pixels, without a gap after the last glyph
+constexpr int16_t bigTextWidth(const char* text)
+{
+    return *text ? bigTextLength(text) * BIG_TEXT_ADVANCE - BIG_TEXT_GAP : 0;
+}
+
+// Left edge that centers the text in a span, for literals this is worked
+// out by the compiler
+constexpr int16_t bigTextCenter(const char* text, int16_t left, int16_t width)
+{
+    return left + (width - bigTextWidth(text)) / 2;
+}
+
+// Draw text with its top on page topPage. Only the digits and the letters
+// of the option words are available, anything else is left blank.
+void drawBigText(PageDisplay& display, int16_t x, uint8_t topPage, const char* text);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef BUTTON_H
+#define BUTTON_H
+
+#include <Arduino.h>
+
+// A gesture of the encoder push button, once it has finished
+enum ButtonEvent : uint8_t
+{
+    BUTTON_PRESS,           // Pressed and released, with no second press following
+    BUTTON_LONG_PRESS,      // Held down, sent while it's still held
+    BUTTON_DOUBLE_PRESS     // Pressed twice in quick succession
+};
+
+// Arm the pin change interrupt on the button and the Timer2 tick that
+// debounces it. onEvent is called from the interrupt after each event is
+// queued, it may be null.
+void buttonBegin(void (*onEvent)());
+
+// Called from the shared PCINT2 handler in pin_change.cpp.
+void buttonPinChanged();
+
+// Take the oldest event off the queue, false when there are none left.
+bool buttonReadEvent(ButtonEvent& event);
+
+// True while the button is settling or a gesture is being timed. The tick
+// runs from Timer2, which stops in power down, so keep the clocks running.
+bool buttonBusy();
+
+// Events lost because the queue was full.
+uint8_t buttonDroppedCount();
+
+#ifndef __AVR__
+// Host-side mock: queue an event as if the button had been pressed.
+void buttonMockEvent(ButtonEvent event);
+#endif
+
+#endif
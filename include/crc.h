@@ -0,0 +1,28 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <stdint.h>
+
+// CRC-8/MAXIM (the 1-Wire CRC), bitwise so it costs no table in flash
+inline uint8_t crc8Update(uint8_t crc, uint8_t data)
+{
+    crc ^= data;
+
+    for (uint8_t bit = 0; bit < 8; bit++)
+        crc = (crc & 0x01) ? (crc >> 1) ^ 0x8C : (crc >> 1);
+
+    return crc;
+}
+
+// CRC-16/CCITT-FALSE (polynomial 0x1021, start with 0xFFFF), also bitwise
+inline uint16_t crc16Update(uint16_t crc, uint8_t data)
+{
+    crc ^= static_cast<uint16_t>(data) << 8;
+
+    for (uint8_t bit = 0; bit < 8; bit++)
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+
+    return crc;
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef DHT11_H
+#define DHT11_H
+
+#include <Arduino.h>
+
+// A validated, checksum verified reading from the sensor
+struct DhtSample
+{
+    uint8_t humidity;           // Relative humidity, percent
+    int16_t temperatureTenths;  // Temperature, tenths of a degree C
+};
+
+// Configure the data pin and the capture timer. Call once from setup().
+void dhtBegin();
+
+// Drive the start pulse for a new reading. Returns false if a reading is
+// already in flight or the sensor has not rested long enough since the last one.
+bool dhtStartReading();
+
+// Advance the acquisition state machine, never blocks. Call every loop().
+void dhtUpdate();
+
+// True while the start pulse or the response capture is in progress.
+bool dhtBusy();
+
+// Returns true once for each new sample published by dhtUpdate().
+bool dhtReadSample(DhtSample& sample);
+
+// Start a reading and wait for it, for use in setup() only.
+bool dhtWaitForSample(DhtSample& sample, uint16_t timeoutMillis);
+
+// Called from the shared PCINT2 handler in pin_change.cpp.
+void dhtPinChanged();
+
+// Number of readings dropped for timeouts or bad checksums.
+uint16_t dhtErrorCount();
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef DISPLAY_PAGES_H
+#define DISPLAY_PAGES_H
+
+#include <Arduino.h>
+
+// Forget what has been sent so every page counts as changed.
+void displayInvalidatePages();
+
+// True when page differs from what was last sent for it, and remember it
+// as sent. Pages are 8 pixel rows, one byte per column.
+bool displayPageChanged(uint8_t page, const uint8_t* data, uint8_t width);
+
+#endif
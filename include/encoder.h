@@ -0,0 +1,32 @@
+#ifndef ENCODER_H
+#define ENCODER_H
+
+#include <Arduino.h>
+
+// One detent of the knob
+struct EncoderEvent
+{
+    int8_t steps;       // +1/-1 per detent, +10/-10 when spun quickly
+    uint16_t time;      // Low 16 bits of millis() when the detent completed
+};
+
+// Attach the pin interrupts. onDetent is called from the interrupt after
+// each event is queued, it may be null.
+void encoderBegin(void (*onDetent)());
+
+// The interrupt handler for both encoder pins. Also call it after waking
+// from power down, where the pin interrupts can't see edges.
+void encoderChanged();
+
+// Take the oldest detent off the queue, false when there are none left.
+bool encoderReadEvent(EncoderEvent& event);
+
+// Detents lost because the queue was full.
+uint8_t encoderDroppedCount();
+
+#ifndef __AVR__
+// Host-side mock: queue a detent as if the knob had been turned.
+void encoderMockDetent(int8_t steps);
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef FAN_OUTPUT_H
+#define FAN_OUTPUT_H
+
+#include <Arduino.h>
+
+// Fans wired straight to the PWM pins, or with -DFAN_SHIFT_REGISTER a
+// chain of 74HC595s driving up to 16 relays. That chain is 8 fans unless
+// the build sets FAN_COUNT too.
+#ifdef FAN_SHIFT_REGISTER
+#ifndef FAN_COUNT
+#define FAN_COUNT 8
+#endif
+#else
+#define FAN_COUNT 4
+#endif
+
+static_assert(FAN_COUNT >= 1 && FAN_COUNT <= 16, "Fan masks are 16 bits");
+
+#define FAN_ALL static_cast<uint16_t>((1UL << FAN_COUNT) - 1)
+
+// Full speed, duty is out of 255 like analogWrite()
+#define FAN_DUTY_MAX 255
+
+// Set up the fan outputs, all off, with the PWM timers disconnected.
+void fanOutputBegin();
+
+// Drive each fan at its duty, index 0 is fan 1. On the pins, off and full
+// speed are plain port levels and anything between connects the pin to
+// its PWM timer (Timer0 for D6/D5, Timer1 for D10/D9). Relays on the shift
+// register are on for any duty, and all of them are sent in one SPI burst.
+// Only the outputs that changed are touched.
+void fanOutputApply(const uint8_t duty[FAN_COUNT]);
+
+// The duty last applied to a fan. A relay reads back the duty it was
+// given too, it's on for any of them.
+uint8_t fanOutputDuty(uint8_t fan);
+
+// The fans running at all, bit 0 is fan 1.
+uint16_t fanOutputMask();
+
+// True while a fan is on PWM. The timers stop in power down, which would
+// leave the pin stuck wherever the cycle was.
+bool fanOutputPwmActive();
+
+// Number of port, timer or SPI writes made, for measuring the driver.
+uint16_t fanOutputWriteCount();
+
+#if !defined(__AVR__) && !defined(FAN_SHIFT_REGISTER)
+// Host-side mock of the two output ports, so the switching logic can be
+// checked without hardware. Fans on PWM read back low, as the port bits
+// are while the timer drives the pin.
+uint8_t fanMockPortB();
+uint8_t fanMockPortD();
+#endif
+
+#endif
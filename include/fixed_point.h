@@ -0,0 +1,31 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+// Integer stand-ins for the sensor maths. The ATmega328 has no FPU, so any
+// float here would pull in the soft-float library.
+
+// Celsius tenths to Fahrenheit tenths, rounded: F = C * 9 / 5 + 32. Good
+// for anything a DHT sensor can report without overflowing 16 bits.
+inline int16_t celsiusToFahrenheitTenths(int16_t celsiusTenths)
+{
+    int16_t scaled = celsiusTenths * 9;
+
+    return (scaled + (scaled < 0 ? -2 : 2)) / 5 + 320;
+}
+
+// Tenths to whole units, rounding halves away from zero
+inline int16_t roundTenths(int16_t tenths)
+{
+    return (tenths + (tenths < 0 ? -5 : 5)) / 10;
+}
+
+// A 12-bit oversampled ADC reading as 0 to 100 percent of full scale,
+// rounded. 25 / 1024 is 100 / 4096, the product needs 32 bits.
+inline uint8_t adcToPercent(uint16_t reading)
+{
+    return static_cast<uint8_t>((static_cast<uint32_t>(reading) * 25 + 512) >> 10);
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <Arduino.h>
+
+// The series kept, all sampled together
+#define HISTORY_TEMPERATURE 0   // Fahrenheit tenths
+#define HISTORY_HUMIDITY 1      // Percent
+#define HISTORY_SOLAR 2         // Percent
+#define HISTORY_SERIES 3
+
+// Samples are kept in blocks and the oldest whole block goes when the ring
+// is full, so the window holds between HISTORY_SAMPLES - HISTORY_BLOCK_SAMPLES
+// and HISTORY_SAMPLES of them. 96 samples 5 minutes apart is 8 hours.
+#define HISTORY_BLOCK_SAMPLES 16
+#define HISTORY_BLOCKS 6
+#define HISTORY_SAMPLES (HISTORY_BLOCK_SAMPLES * HISTORY_BLOCKS)
+
+#ifndef HISTORY_INTERVAL_MILLIS
+#define HISTORY_INTERVAL_MILLIS 300000UL
+#endif
+
+// Find the newest archived block, with -DHISTORY_EEPROM. Call once at boot.
+void historyBegin();
+
+// Add one sample of every series. Each block starts with its exact values,
+// the rest are 8-bit steps from the sample before, so a bigger change is
+// spread over the following samples.
+void historyAdd(const int16_t values[HISTORY_SERIES]);
+
+// Samples in the window, the same for every series.
+uint8_t historyCount();
+
+// Samples added since boot, changes whenever the window does.
+uint16_t historyRevision();
+
+// Kept up to date as samples come and go from per-block summaries, there's
+// no scan of the window. Meaningless while historyCount() is 0.
+int16_t historyLatest(uint8_t series);
+int16_t historyMinimum(uint8_t series);
+int16_t historyMaximum(uint8_t series);
+int16_t historyMean(uint8_t series);
+
+// Walks one series' window, oldest sample first.
+class HistoryReader
+{
+public:
+    explicit HistoryReader(uint8_t series);
+
+    bool next(int16_t& value);
+
+private:
+    uint8_t series;
+    uint8_t position;
+    uint8_t remaining;
+    int16_t value;
+};
+
+#ifdef HISTORY_EEPROM
+// A block that left the window, as archived round-robin in the upper half
+// of the EEPROM. That's 9 blocks, 12 hours more at the default interval.
+struct HistoryBlock
+{
+    uint16_t sequence;
+    int16_t first[HISTORY_SERIES];
+    int8_t steps[HISTORY_SERIES][HISTORY_BLOCK_SAMPLES - 1];
+};
+
+// Write the next byte of a block waiting to be archived if the EEPROM is
+// ready, never waits. Returns true while bytes are left to write.
+bool historyUpdate();
+
+// Archived blocks, oldest first. Returns false when there's no such block.
+uint8_t historyArchiveCount();
+bool historyArchiveRead(uint8_t index, HistoryBlock& block);
+#endif
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef PAGE_DISPLAY_H
+#define PAGE_DISPLAY_H
+
+#include <Arduino.h>
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+
+// Widest panel supported, the size of each page buffer
+#define PAGE_DISPLAY_MAX_WIDTH 128
+
+// Page buffers, one can be drawn while the other is sent
+#define PAGE_DISPLAY_BUFFERS 2
+
+// SSD1306 driver that draws one 8 pixel page at a time into a 128 byte
+// buffer instead of keeping a framebuffer for the whole panel. The screen
+// is drawn once per page, drawing outside the current page is clipped, and
+// each page is queued for the TWI interrupt as soon as it's drawn if the
+// panel doesn't already show it. Drawing never waits on I2C; when both
+// buffers are still being sent, come back later:
+//
+//     while (page < display.pageCount() && display.canDraw())
+//     {
+//         display.beginPage(page++);
+//         drawScreen();
+//         display.endPage();
+//     }
+//
+// The drawing calls follow Adafruit GFX, text uses the same 6x8 cell per
+// character so layouts carry over.
+class PageDisplay
+{
+public:
+    PageDisplay(uint8_t width, uint8_t height);
+
+    // Initialise the panel at this I2C address, with its charge pump on.
+    // False when the panel didn't acknowledge the setup or the bus is stuck,
+    // leave the display alone then.
+    bool begin(uint8_t address);
+
+    uint8_t pageCount() const { return screenHeight / 8; }
+
+    // True when a page buffer is free to draw into
+    bool canDraw() const;
+
+    // Clear a free buffer and clip drawing to this page
+    void beginPage(uint8_t page);
+
+    // Queue the page just drawn, if the panel doesn't already show it
+    void endPage();
+
+    // True while pages are still being sent
+    bool busy() const;
+
+    // Resend every page on the next pass, after the panel lost its RAM
+    void invalidate();
+
+    // True once when a transfer has failed since the last call, and every
+    // page is resent on the next pass. Check it once nothing is busy.
+    bool sendFailed();
+
+    int16_t width() const { return screenWidth; }
+    int16_t height() const { return screenHeight; }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color);
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color);
+
+    // True when the page being drawn is one of count pages from first
+    bool drawingPages(uint8_t first, uint8_t count) const { return page >= first && page < first + count; }
+
+    // OR in a PROGMEM bitmap stored a page at a time, width bytes per page,
+    // with its top on page topPage. Whole bytes only, so it's a plain copy.
+    void drawPageBitmap(int16_t x, uint8_t topPage, const uint8_t* bitmap, uint8_t width, uint8_t pages);
+
+    void setTextSize(uint8_t size) { textSize = size; }
+    void setTextColor(uint16_t color) { textColor = color; }
+    void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+    void print(const char* text);
+    void print(int value);
+    void printProgmem(const char* text);
+
+    int16_t textWidth(const char* text) const;
+    int16_t textHeight() const;
+
+private:
+    // A page and the command that windows the panel RAM to it, both have to
+    // stay put until the interrupt has sent them
+    struct PageBuffer
+    {
+        uint8_t window[6];
+        uint8_t pixels[PAGE_DISPLAY_MAX_WIDTH];
+        uint8_t ticket;     // Of the pixel transfer, the last one queued
+        bool queued;
+    };
+
+    bool bufferFree(uint8_t index) const;
+    void drawChar(char c);
+
+    uint8_t address;
+    uint16_t sendErrors;    // twiErrorCount() as of the last check
+    uint8_t screenWidth;
+    uint8_t screenHeight;
+    uint8_t page;
+    int16_t pageTop;
+
+    PageBuffer buffers[PAGE_DISPLAY_BUFFERS];
+    uint8_t drawing;    // Index of the buffer being drawn
+    uint8_t* buffer;    // Its pixels
+
+    int16_t cursorX;
+    int16_t cursorY;
+    uint8_t textSize;
+    uint16_t textColor;
+};
+
+#endif
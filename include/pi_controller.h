@@ -0,0 +1,64 @@
+#ifndef PI_CONTROLLER_H
+#define PI_CONTROLLER_H
+
+#include <stdint.h>
+
+// Steps longer than this are treated as this long, so a stalled loop
+// can't wind the integral up in one go.
+#define PI_MAX_STEP_MILLIS 2000
+
+// Errors are limited to this, which keeps every product inside 32 bits.
+#define PI_MAX_ERROR 1000
+
+// Full output in Q8
+#define PI_OUTPUT_MAX (static_cast<int32_t>(255) << 8)
+
+// Fixed-point PI controller with a 0 to 255 output, where a positive error
+// asks for more output. Gains are Q8: kp of 256 is one step of output per
+// unit of error, ki of 256 one step per unit of error each second. The
+// integral is clamped to the output range, so it can't wind up while the
+// output is saturated.
+class PiController
+{
+public:
+    PiController(int16_t kp, int16_t ki) : kp(kp), ki(ki), integral(0)
+    {
+    }
+
+    void reset()
+    {
+        integral = 0;
+    }
+
+    // Advance by elapsedMillis with the current error, returns the output
+    uint8_t update(int16_t error, uint16_t elapsedMillis)
+    {
+        if (error > PI_MAX_ERROR)
+            error = PI_MAX_ERROR;
+        else if (error < -PI_MAX_ERROR)
+            error = -PI_MAX_ERROR;
+
+        if (elapsedMillis > PI_MAX_STEP_MILLIS)
+            elapsedMillis = PI_MAX_STEP_MILLIS;
+
+        // The rate times the step, split so the product never overflows
+        int32_t rate = static_cast<int32_t>(ki) * error;
+        integral += (rate / 1000) * elapsedMillis + (rate % 1000) * elapsedMillis / 1000;
+        integral = clamp(integral);
+
+        int32_t output = clamp(static_cast<int32_t>(kp) * error + integral);
+        return static_cast<uint8_t>((output + 128) >> 8);
+    }
+
+private:
+    static int32_t clamp(int32_t value)
+    {
+        return (value < 0) ? 0 : (value > PI_OUTPUT_MAX) ? PI_OUTPUT_MAX : value;
+    }
+
+    int16_t kp;
+    int16_t ki;
+    int32_t integral;   // Q8 output
+};
+
+#endif
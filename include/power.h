@@ -0,0 +1,36 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <Arduino.h>
+
+// Set up the wake sources. inputChanged is called from the pin change
+// interrupt when the encoder or button wakes the MCU from power down, since
+// the INT0/INT1 edge interrupts can't see edges while the clock is stopped.
+void powerBegin(void (*inputChanged)());
+
+// Ask to be woken no later than this many milliseconds from now. The
+// earliest request made during a loop() pass wins.
+void powerWakeWithin(unsigned long millisFromNow);
+
+// Something needs the timers this pass (a sensor capture, a debounce), so
+// only idle sleep is allowed.
+void powerKeepClocked();
+
+// Sleep until the earliest requested wake time or an input interrupt. Call
+// once at the end of loop(). Fan outputs are plain port levels and hold
+// their state in every sleep mode.
+void powerSleep();
+
+// Sleep in ADC Noise Reduction mode until the conversion it starts is done
+// (or another interrupt wakes us). Timer0 stops too, so conversionMicros is
+// credited to millis() once the conversion has finished.
+void powerSleepForAdc(unsigned int conversionMicros);
+
+// Percentage of time spent awake since the last reset of the statistics.
+uint8_t powerAwakePercent();
+void powerResetStats();
+
+// Called from the shared PCINT2 handler in pin_change.cpp.
+void powerPinChanged();
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+// Per-stage timing for the hot paths. Build with -DPROFILE_STAGES to turn
+// it on; without it the macro expands to nothing and no table is linked.
+// PROFILE_STAGE times from where it appears to the end of its scope, early
+// returns included.
+//
+//     void updateDHT()
+//     {
+//         PROFILE_STAGE(PROFILE_DHT);
+//         ...
+//     }
+
+#define PROFILE_EDIT_MODE 0
+#define PROFILE_ENCODER 1
+#define PROFILE_DHT 2
+#define PROFILE_SOLAR 3
+#define PROFILE_RENDER 4    // Render and flush are timed once per display page
+#define PROFILE_FLUSH 5
+#define PROFILE_FANS 6
+#define PROFILE_STAGE_COUNT 7
+
+struct StageStats
+{
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint32_t totalCycles;   // Halved along with count before it can overflow
+    uint16_t count;
+};
+
+#ifdef PROFILE_STAGES
+
+#define PROFILE_STAGE(stage) ProfileScope profileScope(stage)
+
+// CPU cycles since reset, to the resolution of micros()
+inline uint32_t profilerCycles()
+{
+    return micros() * clockCyclesPerMicrosecond();
+}
+
+void profilerRecord(uint8_t stage, uint32_t cycles);
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(uint8_t stage) : stage(stage), start(profilerCycles()) { }
+    ~ProfileScope() { profilerRecord(stage, profilerCycles() - start); }
+
+private:
+    uint8_t stage;
+    uint32_t start;
+};
+
+const StageStats& profilerStats(uint8_t stage);
+uint32_t profilerAverageCycles(uint8_t stage);
+const char* profilerStageName(uint8_t stage);
+void profilerReset();
+
+#else
+
+#define PROFILE_STAGE(stage) do { } while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef RING_FILTER_H
+#define RING_FILTER_H
+
+#include <stdint.h>
+
+// Moving average over the last N samples. The sum is kept up to date as
+// samples come and go, so adding a sample is O(1), and N must be a power
+// of two so the average is a shift instead of a divide, which rounds down.
+// Sum must be wide enough to hold N times the largest sample.
+template <typename T, uint8_t N, typename Sum = uint16_t>
+class RingFilter
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "RingFilter size must be a power of two");
+
+public:
+    RingFilter() : index(0), sum(0)
+    {
+        fill(0);
+    }
+
+    // Set every sample to value, used to seed the filter from a first reading
+    void fill(T value)
+    {
+        for (uint8_t i = 0; i < N; i++)
+            samples[i] = value;
+
+        sum = static_cast<Sum>(value) * N;
+        index = 0;
+    }
+
+    // Replace the oldest sample and return the new average
+    T add(T value)
+    {
+        sum -= samples[index];
+        sum += value;
+        samples[index] = value;
+        index = (index + 1) & (N - 1);
+
+        return average();
+    }
+
+    T average() const
+    {
+        return static_cast<T>(sum >> shift);
+    }
+
+    // Sample i, where 0 is the oldest and N - 1 the newest
+    T sample(uint8_t i) const
+    {
+        return samples[(index + i) & (N - 1)];
+    }
+
+    static uint8_t size()
+    {
+        return N;
+    }
+
+private:
+    static constexpr uint8_t log2(uint8_t n)
+    {
+        return (n <= 1) ? 0 : 1 + log2(n >> 1);
+    }
+
+    static constexpr uint8_t shift = log2(N);
+
+    T samples[N];
+    uint8_t index;
+    Sum sum;
+};
+
+// Running median of the last N samples, N should be small. A sorted copy of
+// the window is kept alongside the ring, so each sample costs O(N) moves
+// instead of a sort. An even N gives the mean of the middle two, rounded
+// down like the other filters.
+template <typename T, uint8_t N>
+class MedianFilter
+{
+    static_assert(N > 0, "MedianFilter needs a sample");
+
+public:
+    MedianFilter() : index(0)
+    {
+        fill(0);
+    }
+
+    void fill(T value)
+    {
+        for (uint8_t i = 0; i < N; i++)
+        {
+            samples[i] = value;
+            sorted[i] = value;
+        }
+
+        index = 0;
+    }
+
+    // Replace the oldest sample and return the new median
+    T add(T value)
+    {
+        T oldest = samples[index];
+        samples[index] = value;
+        index = (index + 1 >= N) ? 0 : index + 1;
+
+        // Find the oldest sample in the sorted window
+        uint8_t i = 0;
+        while (sorted[i] != oldest)
+            i++;
+
+        // Slide neighbours over until the new value fits in order
+        while (i > 0 && sorted[i - 1] > value)
+        {
+            sorted[i] = sorted[i - 1];
+            i--;
+        }
+
+        while (i < N - 1 && sorted[i + 1] < value)
+        {
+            sorted[i] = sorted[i + 1];
+            i++;
+        }
+
+        sorted[i] = value;
+
+        return median();
+    }
+
+    T median() const
+    {
+        if (N & 1)
+            return sorted[N / 2];
+
+        return static_cast<T>((static_cast<int32_t>(sorted[N / 2 - 1]) + sorted[N / 2]) >> 1);
+    }
+
+private:
+    T samples[N];
+    T sorted[N];
+    uint8_t index;
+};
+
+// Exponential moving average with a smoothing factor of 1 / 2^Shift. Only the
+// scaled accumulator is stored, so it costs a few bytes regardless of the
+// time constant. The average is a shift, so it rounds down, and a steady
+// input is reached exactly from either side.
+template <typename T, uint8_t Shift, typename Acc = int32_t>
+class EmaFilter
+{
+public:
+    EmaFilter() : accumulator(0)
+    {
+    }
+
+    void fill(T value)
+    {
+        // A multiply, shifting a negative value left isn't defined
+        accumulator = static_cast<Acc>(value) * (static_cast<Acc>(1) << Shift);
+    }
+
+    T add(T value)
+    {
+        accumulator += static_cast<Acc>(value) - (accumulator >> Shift);
+
+        return average();
+    }
+
+    T average() const
+    {
+        return static_cast<T>(accumulator >> Shift);
+    }
+
+private:
+    Acc accumulator;
+};
+
+// Least-squares slope over the last N samples, taking them as evenly spaced
+// with the oldest at 0. The sum and the index-weighted sum are updated as
+// samples come and go, so adding a sample is O(1) like RingFilter. Samples
+// times N^3 / 2 must fit in 32 bits, which holds 16-bit samples up to N = 32.
+template <typename T, uint8_t N>
+class TrendFilter
+{
+    static_assert(N > 1 && N <= 32, "TrendFilter size must be 2 to 32");
+
+public:
+    TrendFilter() : index(0), sum(0), weighted(0)
+    {
+        fill(0);
+    }
+
+    // Set every sample to value, a flat trend
+    void fill(T value)
+    {
+        for (uint8_t i = 0; i < N; i++)
+            samples[i] = value;
+
+        sum = static_cast<int32_t>(value) * N;
+        weighted = static_cast<int32_t>(value) * xSum;
+        index = 0;
+    }
+
+    // Replace the oldest sample, every other sample moves one step older
+    void add(T value)
+    {
+        T oldest = samples[index];
+
+        weighted += static_cast<int32_t>(value) * (N - 1) - sum + oldest;
+        sum += static_cast<int32_t>(value) - oldest;
+        samples[index] = value;
+        index = (index + 1 >= N) ? 0 : index + 1;
+    }
+
+    // Change per sample in Q8
+    int32_t slope() const
+    {
+        // N * sum(xy) - sum(x) * sum(y), over the constant N * sum(x^2) - sum(x)^2,
+        // split like PiController so scaling to Q8 can't overflow
+        int32_t numerator = weighted * N - xSum * sum;
+
+        return (numerator / denominator) * 256 + (numerator % denominator) * 256 / denominator;
+    }
+
+    // How far the trend carries over the next count samples
+    T change(uint16_t count) const
+    {
+        return static_cast<T>(slope() * count / 256);
+    }
+
+private:
+    static constexpr int32_t xSum = static_cast<int32_t>(N) * (N - 1) / 2;
+    static constexpr int32_t denominator = static_cast<int32_t>(N) * N * (static_cast<int32_t>(N) * N - 1) / 12;
+
+    T samples[N];
+    uint8_t index;
+    int32_t sum;
+    int32_t weighted;   // Each sample times its age order, oldest 0
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+#define SCHEDULER_MAX_TASKS 10
+#define SCHEDULER_NO_TASK 0xFF
+
+typedef void (*TaskFunction)();
+
+struct TaskStats
+{
+    uint16_t runs;          // Times the task has run
+    uint16_t overruns;      // Times a whole period was missed
+    uint16_t maxLateMillis; // Worst delay between due time and start
+    uint16_t maxRunMicros;  // Longest single run
+};
+
+// True once now has reached deadline, correct across millis() wrapping
+inline bool timeReached(unsigned long now, unsigned long deadline)
+{
+    return static_cast<long>(now - deadline) >= 0;
+}
+
+// Add a task that runs every periodMillis, starting on the next pass.
+// Returns the task id, or SCHEDULER_NO_TASK when the table is full.
+uint8_t schedulerAdd(TaskFunction function, uint16_t periodMillis);
+
+// Run every task that is due. Call once per loop().
+void schedulerRunDue();
+
+// Run a task on the next pass regardless of its period. Safe to call from
+// an interrupt.
+void schedulerTrigger(uint8_t task);
+
+// True when a task has been triggered since the last schedulerRunDue().
+// Meant to be checked with interrupts off, right before sleeping.
+bool schedulerTriggered();
+
+// Run a task once more this many milliseconds from now, for work that has
+// to be polled while it's in progress. The periodic schedule is unchanged.
+void schedulerDelay(uint8_t task, uint16_t delayMillis);
+
+// Passes that have run a task earlier in this millisecond. Inputs taken
+// at the same millis() can land either side of one, the trace records
+// which so the replay can take them in the same order.
+uint8_t schedulerPassesThisMillis();
+
+// Milliseconds until the next task is due, 0 if one is due now.
+unsigned long schedulerMillisUntilNext();
+
+const TaskStats& schedulerStats(uint8_t task);
+uint8_t schedulerTaskCount();
+
+// Percentage of time spent running tasks since the last reset, the rest
+// is headroom.
+uint8_t schedulerLoadPercent();
+void schedulerResetStats();
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include <Arduino.h>
+
+#include "fan_output.h"
+
+// The user settings as they are stored in EEPROM
+struct Settings
+{
+    uint8_t temperature;
+    uint8_t humidity;
+    uint8_t solar;
+    uint8_t fans[FAN_COUNT];
+    uint8_t power;
+};
+
+// Find the newest valid record. Returns false when the store is empty.
+bool settingsLoad(Settings& settings);
+
+// Queue settings to be written as a new record, unless they match the
+// newest record already stored. Returns false when nothing needs writing.
+bool settingsSave(const Settings& settings);
+
+// Write the next byte of a queued record if the EEPROM is ready, never
+// waits for a write to finish. Returns true while bytes are left to write.
+bool settingsUpdate();
+
+// Records written since boot.
+uint16_t settingsWriteCount();
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef SOLAR_ADC_H
+#define SOLAR_ADC_H
+
+#include <Arduino.h>
+
+#define SOLAR_ADC_PIN A0
+
+// 16 samples decimated by 4 give two extra bits, a 12-bit result
+#define SOLAR_ADC_SAMPLES 16
+#define SOLAR_ADC_MAX 4095
+
+// Interrupt driven sampling of the solar panel input. A block of samples is
+// converted on every Timer0 overflow (about 1kHz) and summed by the ADC
+// interrupt, so it takes about 16ms with the timers running. Build with
+// -DSOLAR_ADC_NOISE_REDUCTION to convert the block in ADC Noise Reduction
+// sleep instead, about 1.7ms with the CPU and I/O clocks stopped.
+void solarAdcBegin();
+
+// Start sampling a block. In noise reduction builds it's done on return.
+void solarAdcStart();
+
+// True while a block is being sampled.
+bool solarAdcBusy();
+
+// The result of the last block, 0 to SOLAR_ADC_MAX. Returns true once per
+// block, false while it's still being sampled or has been read already.
+bool solarAdcRead(uint16_t& value);
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+
+// Keeps the compiler from moving memory accesses across this point
+#define SPSC_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+// Lock-free ring for exactly one producer (typically an ISR) and one
+// consumer (typically loop()). The head is only written by the producer and
+// the tail only by the consumer, and both are single bytes, so neither side
+// ever needs to disable interrupts. N must be a power of two, up to 128.
+template <typename T, uint8_t N>
+class SpscQueue
+{
+    static_assert(N > 0 && N <= 128 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two up to 128");
+
+public:
+    SpscQueue() : head(0), tail(0)
+    {
+    }
+
+    // Producer side. Returns false, dropping the item, when full.
+    bool push(const T& item)
+    {
+        uint8_t h = head;
+
+        if (static_cast<uint8_t>(h - tail) >= N)
+            return false;
+
+        items[h & (N - 1)] = item;
+
+        // The item must be stored before the consumer can see it
+        SPSC_BARRIER();
+        head = h + 1;
+
+        return true;
+    }
+
+    // Consumer side. Returns false when empty.
+    bool pop(T& item)
+    {
+        uint8_t t = tail;
+
+        if (t == head)
+            return false;
+
+        SPSC_BARRIER();
+        item = items[t & (N - 1)];
+
+        // The item must be copied out before the producer can reuse the slot
+        SPSC_BARRIER();
+        tail = t + 1;
+
+        return true;
+    }
+
+    bool empty() const
+    {
+        return head == tail;
+    }
+
+    uint8_t size() const
+    {
+        return static_cast<uint8_t>(head - tail);
+    }
+
+private:
+    T items[N];
+    volatile uint8_t head;
+    volatile uint8_t tail;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+
+// Frame layout, multi-byte fields little-endian:
+//   sync (0xA5 0x5A), type, payload length, sequence (2 bytes), payload,
+//   CRC-16/CCITT-FALSE of type through payload (2 bytes)
+// tools/telemetry_decode.py reads the same layout, keep the two in step.
+#define TELEMETRY_SYNC1 0xA5
+#define TELEMETRY_SYNC2 0x5A
+#define TELEMETRY_HEADER_SIZE 6
+#define TELEMETRY_CRC_SIZE 2
+
+// Frame types
+#define TELEMETRY_STATUS 0x01
+
+// Trace frames, sent by -DTRACE_RECORD builds (see trace.h). Each starts
+// with the millis() it was taken at.
+#define TELEMETRY_TRACE_BOOT 0x10   // TraceBoot, then the Settings record
+#define TELEMETRY_TRACE_DHT 0x11    // TraceDht
+#define TELEMETRY_TRACE_SOLAR 0x12  // TraceSolar
+#define TELEMETRY_TRACE_INPUT 0x13  // TraceInput
+#define TELEMETRY_TRACE_FANS 0x14   // TraceFans, then one duty per fan
+
+// Bits of TelemetryStatus::flags
+#define TELEMETRY_FLAG_EDIT 0x01
+#define TELEMETRY_FLAG_NO_DISPLAY 0x02     // The panel didn't answer at boot
+
+// Everything the controller is doing, sent once a second and on changes
+struct TelemetryStatus
+{
+    int16_t temperatureTenths;  // Fahrenheit
+    uint8_t humidity;
+    uint8_t solar;
+    uint8_t setTemperature;
+    uint8_t setHumidity;
+    uint8_t setSolar;
+    uint16_t fans;              // Bit n set when fan n+1 is running
+    uint8_t power;
+    uint8_t flags;
+    uint8_t screen;
+    uint32_t uptimeMillis;
+} __attribute__((packed));
+
+static_assert(sizeof(TelemetryStatus) == 16, "TelemetryStatus layout is part of the protocol");
+
+// Once at boot, before the first readings. The Settings record follows:
+// temperature, humidity, solar, fanCount fan options, power.
+struct TraceBoot
+{
+    uint32_t millis;
+    uint8_t fanCount;
+} __attribute__((packed));
+
+// A reading as updateDHT() took it, temperature still in Celsius tenths
+struct TraceDht
+{
+    uint32_t millis;
+    uint8_t humidity;
+    int16_t temperatureTenths;
+} __attribute__((packed));
+
+// A 12-bit block as updateSolar() took it
+struct TraceSolar
+{
+    uint32_t millis;
+    uint16_t reading;
+} __attribute__((packed));
+
+// A detent as updateEncoder() took it, or a button event updateEditMode()
+// took, with steps 0
+struct TraceInput
+{
+    uint32_t millis;
+    int8_t steps;
+    uint8_t button;     // ButtonEvent, when steps is 0
+    uint8_t pass;       // schedulerPassesThisMillis() when it was taken
+} __attribute__((packed));
+
+// Whenever updateAllFans() changes a duty, the duties follow
+struct TraceFans
+{
+    uint32_t millis;
+    uint8_t fanCount;
+} __attribute__((packed));
+
+static_assert(sizeof(TraceBoot) == 5 && sizeof(TraceDht) == 7 && sizeof(TraceSolar) == 6 &&
+              sizeof(TraceInput) == 7 && sizeof(TraceFans) == 5, "Trace layouts are part of the protocol");
+
+// Queue a frame for sending. Returns false, dropping the whole frame, when
+// the TX ring doesn't have room for it.
+bool telemetrySend(uint8_t type, const void* payload, uint8_t length);
+
+// Move queued bytes into the UART without blocking, as many as its buffer
+// has room for. Call regularly.
+void telemetryFlush();
+
+// Send everything still queued, waiting on the UART if needed. Call before
+// printing text so it can't land in the middle of a frame.
+void telemetryDrain();
+
+// Frames lost because the TX ring was full.
+uint16_t telemetryDroppedCount();
+
+#endif
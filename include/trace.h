@@ -0,0 +1,40 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+
+#include "button.h"
+#include "dht11.h"
+#include "fan_output.h"
+#include "settings_store.h"
+
+// Sensor and input trace for reproducing a unit's behaviour on the host.
+// Build with -DTRACE_RECORD to send every reading, detent and button
+// event the controller takes, and every fan duty it applies, as telemetry
+// frames (TELEMETRY_TRACE_* in telemetry.h). native/replay feeds a capture
+// back through the same hooks and diffs the fan duties. Without the flag
+// the calls compile away.
+//
+// Trace from boot: replay starts from the settings and first readings.
+
+#ifdef TRACE_RECORD
+
+void traceBoot(const Settings& settings);
+void traceDht(const DhtSample& sample);
+void traceSolar(uint16_t reading);
+void traceDetent(int8_t steps);
+void traceButton(ButtonEvent event);
+void traceFans();
+
+#else
+
+inline void traceBoot(const Settings&) { }
+inline void traceDht(const DhtSample&) { }
+inline void traceSolar(uint16_t) { }
+inline void traceDetent(int8_t) { }
+inline void traceButton(ButtonEvent) { }
+inline void traceFans() { }
+
+#endif
+
+#endif
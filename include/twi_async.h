@@ -0,0 +1,30 @@
+#ifndef TWI_ASYNC_H
+#define TWI_ASYNC_H
+
+#include <Arduino.h>
+
+// Interrupt driven I2C master, write only. Transfers are queued and sent in
+// the background by the TWI interrupt, so loop() only submits them and
+// checks tickets. Takes over the TWI hardware, don't link Wire alongside it.
+#define TWI_CLOCK 400000
+#define TWI_QUEUE_SIZE 4
+
+// Set up the pins and bit rate.
+void twiBegin();
+
+// Queue a write of a control byte followed by length bytes of data to the
+// device at address. data isn't copied, leave it alone until the transfer
+// is done. Returns a ticket for twiDone(), waits for room when the queue
+// is full.
+uint8_t twiSubmit(uint8_t address, uint8_t control, const uint8_t* data, uint8_t length);
+
+// True once the transfer with this ticket has finished, sent or failed.
+bool twiDone(uint8_t ticket);
+
+// True while any transfer is queued or being sent.
+bool twiBusy();
+
+// Transfers that were not acknowledged or lost the bus.
+uint16_t twiErrorCount();
+
+#endif
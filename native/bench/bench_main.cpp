@@ -0,0 +1,188 @@
+// Loop-time benchmarks for the firmware, built by the native environment.
+// Each stage runs against the mocks in native/mock, so the times are host
+// times; compare them run to run rather than against the AVR.
+
+#include <chrono>
+#include <stdio.h>
+
+#include "mock_hal.h"
+#include <Arduino.h>
+#include "ring_filter.h"
+#include "settings_store.h"
+
+// From src/main.cpp
+void setup();
+void loop();
+void updateDHT();
+void updateSolar();
+void updateDisplay();
+void updateAllFans();
+void writeSettings();
+void updateSettings();
+
+extern int setTemperature;
+extern int currentScreen;
+extern bool shownViewValid;
+
+#define BENCH_ITERATIONS 2000
+#define SOLAR_PIN A0
+
+typedef std::chrono::steady_clock Clock;
+
+static void report(const char* name, Clock::time_point start, unsigned long runs, const char* extra = "")
+{
+    double total = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    printf("%-20s %10.3f us/run %s\n", name, total / runs, extra);
+}
+
+static void benchDHT()
+{
+    // A full reading: start, poll while it's captured, then publish
+    Clock::time_point start = Clock::now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        mockDhtSet(40 + (i & 15), 200 + (i & 31));
+        mockAdvanceMillis(2000);
+        updateDHT();
+        mockAdvanceMillis(30);
+        updateDHT();
+    }
+
+    report("updateDHT", start, BENCH_ITERATIONS * 2);
+}
+
+static void benchSolar()
+{
+    // A full reading: start a block, then read it once it's sampled
+    Clock::time_point start = Clock::now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        mockSetAnalog(SOLAR_PIN, (i * 7) & 1023);
+        mockAdvanceMillis(500);
+        updateSolar();
+        mockAdvanceMillis(20);
+        updateSolar();
+    }
+
+    report("updateSolar", start, BENCH_ITERATIONS * 2);
+}
+
+static void benchDisplay()
+{
+    char extra[64];
+
+    // Every render changes the view, so pages have to be sent
+    mockResetCounters();
+    Clock::time_point start = Clock::now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        setTemperature = 50 + (i % 40);
+        updateDisplay();
+    }
+
+    snprintf(extra, sizeof(extra), "%lu I2C bytes/run", mockTwiBytes() / BENCH_ITERATIONS);
+    report("updateDisplay", start, BENCH_ITERATIONS, extra);
+
+    // Nothing changed, the view comparison should skip the render
+    mockResetCounters();
+    start = Clock::now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+        updateDisplay();
+
+    snprintf(extra, sizeof(extra), "%lu I2C bytes/run", mockTwiBytes() / BENCH_ITERATIONS);
+    report("updateDisplay same", start, BENCH_ITERATIONS, extra);
+
+    // Forced full renders of an unchanged view, only the page checksums save us
+    mockResetCounters();
+    start = Clock::now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        shownViewValid = false;
+        updateDisplay();
+    }
+
+    snprintf(extra, sizeof(extra), "%lu I2C bytes/run", mockTwiBytes() / BENCH_ITERATIONS);
+    report("updateDisplay redraw", start, BENCH_ITERATIONS, extra);
+}
+
+static void benchFans()
+{
+    Clock::time_point start = Clock::now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        setTemperature = (i & 1) ? 1 : 99;
+        updateAllFans();
+    }
+
+    report("updateAllFans", start, BENCH_ITERATIONS);
+}
+
+static void benchSettings()
+{
+    char extra[64];
+    unsigned long saves = 0;
+
+    // Change one setting and let the store write it out a byte at a time
+    mockResetCounters();
+    Clock::time_point start = Clock::now();
+
+    for (int i = 0; i < BENCH_ITERATIONS / 10; i++)
+    {
+        setTemperature = 50 + (i % 40);
+        writeSettings();
+
+        while (settingsUpdate())
+            mockAdvanceMillis(4);
+
+        saves++;
+    }
+
+    snprintf(extra, sizeof(extra), "%lu EEPROM cells/save", mockEepromWrites() / saves);
+    report("settings save", start, saves, extra);
+}
+
+static void benchLoop()
+{
+    char extra[64];
+    const unsigned long simulatedMillis = 10UL * 60 * 1000;
+
+    // Ten minutes of the real loop, sleeping between tasks like the device
+    mockResetCounters();
+    unsigned long startMillis = millis();
+    unsigned long loops = 0;
+    Clock::time_point start = Clock::now();
+
+    while (millis() - startMillis < simulatedMillis)
+    {
+        loop();
+        loops++;
+    }
+
+    snprintf(extra, sizeof(extra), "%lu loops, asleep %lu%%", loops, mockPowerSleptMillis() * 100 / simulatedMillis);
+    report("loop", start, loops, extra);
+}
+
+int main()
+{
+    mockSetAnalog(SOLAR_PIN, 512);
+    mockDhtSet(45, 215);
+
+    setup();
+    mockSerialClear();
+
+    benchDHT();
+    benchSolar();
+    benchDisplay();
+    benchFans();
+    benchSettings();
+    benchLoop();
+
+    return 0;
+}
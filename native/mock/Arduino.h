@@ -0,0 +1,140 @@
+#ifndef ARDUINO_MOCK_H
+#define ARDUINO_MOCK_H
+
+// Host stand-in for the Arduino core, just enough for the firmware to build
+// and run natively. Note int is 32 bits here and 16 bits on the AVR.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <type_traits>
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+
+#define DEC 10
+#define HEX 16
+
+#ifndef F_CPU
+#define F_CPU 16000000L
+#endif
+#define clockCyclesPerMicrosecond() (F_CPU / 1000000L)
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+#define pgm_read_byte(address) (*reinterpret_cast<const uint8_t*>(address))
+#define pgm_read_word(address) (*reinterpret_cast<const uint16_t*>(address))
+#define pgm_read_ptr(address) (*reinterpret_cast<const void* const*>(address))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+#define _BV(bit) (1 << (bit))
+#define lowByte(w) ((uint8_t)((w) & 0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+
+#define SERIAL_TX_BUFFER_SIZE 64
+
+#define digitalPinToInterrupt(pin) ((pin) == 2 ? 0 : ((pin) == 3 ? 1 : -1))
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+template <typename A, typename B>
+inline typename std::common_type<A, B>::type min(A a, B b)
+{
+    return (a < b) ? a : b;
+}
+
+template <typename A, typename B>
+inline typename std::common_type<A, B>::type max(A a, B b)
+{
+    return (a > b) ? a : b;
+}
+
+template <typename T, typename L, typename H>
+inline T constrain(T value, L low, H high)
+{
+    return (value < low) ? low : ((value > high) ? high : value);
+}
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(), int mode);
+void detachInterrupt(uint8_t interrupt);
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+inline void cli() {}
+inline void sei() {}
+
+char* itoa(int value, char* buffer, int base);
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t value) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+
+    size_t write(const char* text) { return write(reinterpret_cast<const uint8_t*>(text), strlen(text)); }
+
+    size_t print(const char* text);
+    size_t print(char value);
+    size_t print(unsigned char value, int base = DEC);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println();
+    template <typename T>
+    size_t println(T value) { return print(value) + println(); }
+    template <typename T>
+    size_t println(T value, int format) { return print(value, format) + println(); }
+};
+
+class HardwareSerial : public Print
+{
+public:
+    void begin(unsigned long baud);
+    void end() {}
+    int available();
+    int read();
+    int peek();
+    int availableForWrite();
+    void flush() {}
+
+    size_t write(uint8_t value) override;
+    using Print::write;
+
+    explicit operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif
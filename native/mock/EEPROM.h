@@ -0,0 +1,40 @@
+#ifndef EEPROM_MOCK_H
+#define EEPROM_MOCK_H
+
+#include <Arduino.h>
+
+#define EEPROM_MOCK_SIZE 1024
+
+// 1KB of erased (0xFF) cells, counting every cell that actually changes
+class EEPROMClass
+{
+public:
+    EEPROMClass();
+
+    uint8_t read(int address);
+    void write(int address, uint8_t value);
+    void update(int address, uint8_t value);
+    uint16_t length() { return EEPROM_MOCK_SIZE; }
+
+    template <typename T>
+    T& get(int address, T& value)
+    {
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(&value);
+        for (size_t i = 0; i < sizeof(T); i++)
+            bytes[i] = read(address + i);
+        return value;
+    }
+
+    template <typename T>
+    const T& put(int address, const T& value)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        for (size_t i = 0; i < sizeof(T); i++)
+            update(address + i, bytes[i]);
+        return value;
+    }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,238 @@
+#include <stdio.h>
+#include <string>
+
+#include "mock_hal.h"
+#include <Arduino.h>
+
+#define MOCK_PINS 20
+
+HardwareSerial Serial;
+
+static unsigned long nowMicros = 0;
+static uint8_t digitalLevels[MOCK_PINS];
+static int analogValues[MOCK_PINS];
+static std::string serialOutput;
+static std::string serialInput;
+
+void mockAdvanceMicros(unsigned long micros)
+{
+    nowMicros += micros;
+}
+
+void mockAdvanceMillis(unsigned long millis)
+{
+    nowMicros += millis * 1000UL;
+}
+
+unsigned long mockNowMicros()
+{
+    return nowMicros;
+}
+
+void mockSetDigital(uint8_t pin, uint8_t level)
+{
+    if (pin < MOCK_PINS)
+        digitalLevels[pin] = level;
+}
+
+void mockSetAnalog(uint8_t pin, int value)
+{
+    if (pin < MOCK_PINS)
+        analogValues[pin] = value;
+}
+
+const std::string& mockSerialOutput()
+{
+    return serialOutput;
+}
+
+void mockSerialClear()
+{
+    serialOutput.clear();
+}
+
+void mockSerialInput(const std::string& bytes)
+{
+    serialInput += bytes;
+}
+
+unsigned long millis()
+{
+    return nowMicros / 1000UL;
+}
+
+unsigned long micros()
+{
+    return nowMicros;
+}
+
+void delay(unsigned long ms)
+{
+    mockAdvanceMillis(ms);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    mockAdvanceMicros(us);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    // Pulled up inputs idle high, like the button
+    if (pin < MOCK_PINS && mode == INPUT_PULLUP)
+        digitalLevels[pin] = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (pin < MOCK_PINS)
+        digitalLevels[pin] = value ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin)
+{
+    return (pin < MOCK_PINS) ? digitalLevels[pin] : LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+    return (pin < MOCK_PINS) ? analogValues[pin] : 0;
+}
+
+void analogWrite(uint8_t pin, int value)
+{
+    digitalWrite(pin, value > 127 ? HIGH : LOW);
+}
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(), int mode)
+{
+    (void)interrupt;
+    (void)handler;
+    (void)mode;
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+    (void)interrupt;
+}
+
+char* itoa(int value, char* buffer, int base)
+{
+    if (base == 16)
+        sprintf(buffer, "%x", value);
+    else
+        sprintf(buffer, "%d", value);
+
+    return buffer;
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+    size_t written = 0;
+
+    while (size--)
+        written += write(*buffer++);
+
+    return written;
+}
+
+size_t Print::print(const char* text)
+{
+    return write(text);
+}
+
+size_t Print::print(char value)
+{
+    return write(static_cast<uint8_t>(value));
+}
+
+size_t Print::print(unsigned char value, int base)
+{
+    return print(static_cast<unsigned long>(value), base);
+}
+
+size_t Print::print(int value, int base)
+{
+    return print(static_cast<long>(value), base);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+    return print(static_cast<unsigned long>(value), base);
+}
+
+size_t Print::print(long value, int base)
+{
+    char text[24];
+    snprintf(text, sizeof(text), (base == HEX) ? "%lx" : "%ld", value);
+    return print(text);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    char text[24];
+    snprintf(text, sizeof(text), (base == HEX) ? "%lx" : "%lu", value);
+    return print(text);
+}
+
+size_t Print::print(double value, int digits)
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return print(text);
+}
+
+size_t Print::println()
+{
+    return print("\r\n");
+}
+
+void HardwareSerial::begin(unsigned long baud)
+{
+    (void)baud;
+}
+
+int HardwareSerial::available()
+{
+    return static_cast<int>(serialInput.size());
+}
+
+int HardwareSerial::read()
+{
+    if (serialInput.empty())
+        return -1;
+
+    int value = static_cast<uint8_t>(serialInput[0]);
+    serialInput.erase(0, 1);
+
+    return value;
+}
+
+int HardwareSerial::peek()
+{
+    return serialInput.empty() ? -1 : static_cast<uint8_t>(serialInput[0]);
+}
+
+int HardwareSerial::availableForWrite()
+{
+    // The host UART never backs up
+    return SERIAL_TX_BUFFER_SIZE - 1;
+}
+
+size_t HardwareSerial::write(uint8_t value)
+{
+    serialOutput.push_back(static_cast<char>(value));
+    return 1;
+}
+
+// Each mock resets its own counters
+void mockResetTwi();
+void mockResetEeprom();
+void mockResetPower();
+
+void mockResetCounters()
+{
+    mockResetTwi();
+    mockResetEeprom();
+    mockResetPower();
+}
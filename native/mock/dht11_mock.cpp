@@ -0,0 +1,104 @@
+#include "mock_hal.h"
+#include "dht11.h"
+
+// Stands in for dht11.cpp: a reading takes as long as on the device, then
+// returns whatever mockDhtSet() was last given.
+#define DHT_MOCK_READING_MILLIS 25
+#define DHT_MIN_INTERVAL_MILLIS 1000
+
+static DhtSample mockSample = { 50, 200 };
+static bool mockFailing = false;
+
+static bool busy = false;
+static bool started = false;
+static unsigned long startMillis = 0;
+static bool sampleReady = false;
+static DhtSample latest;
+static uint16_t errors = 0;
+
+void mockDhtSet(uint8_t humidity, int16_t temperatureTenths)
+{
+    mockSample.humidity = humidity;
+    mockSample.temperatureTenths = temperatureTenths;
+}
+
+void mockDhtSetFailing(bool failing)
+{
+    mockFailing = failing;
+}
+
+void dhtBegin()
+{
+    busy = false;
+    started = false;
+    sampleReady = false;
+}
+
+bool dhtStartReading()
+{
+    if (busy || (started && millis() - startMillis < DHT_MIN_INTERVAL_MILLIS))
+        return false;
+
+    busy = true;
+    started = true;
+    startMillis = millis();
+
+    return true;
+}
+
+void dhtUpdate()
+{
+    if (!busy || millis() - startMillis < DHT_MOCK_READING_MILLIS)
+        return;
+
+    busy = false;
+
+    if (mockFailing)
+    {
+        errors++;
+        return;
+    }
+
+    latest = mockSample;
+    sampleReady = true;
+}
+
+bool dhtBusy()
+{
+    return busy;
+}
+
+bool dhtReadSample(DhtSample& sample)
+{
+    if (!sampleReady)
+        return false;
+
+    sample = latest;
+    sampleReady = false;
+
+    return true;
+}
+
+bool dhtWaitForSample(DhtSample& sample, uint16_t timeoutMillis)
+{
+    (void)timeoutMillis;
+
+    // The mock clock doesn't run on its own, so skip the wait
+    if (mockFailing)
+        return false;
+
+    started = true;
+    startMillis = millis();
+    sample = mockSample;
+
+    return true;
+}
+
+void dhtPinChanged()
+{
+}
+
+uint16_t dhtErrorCount()
+{
+    return errors;
+}
@@ -0,0 +1,44 @@
+#include "mock_hal.h"
+#include <EEPROM.h>
+
+EEPROMClass EEPROM;
+
+static uint8_t cells[EEPROM_MOCK_SIZE];
+static unsigned long cellWrites = 0;
+
+unsigned long mockEepromWrites()
+{
+    return cellWrites;
+}
+
+void mockEepromErase()
+{
+    memset(cells, 0xFF, sizeof(cells));
+}
+
+void mockResetEeprom()
+{
+    cellWrites = 0;
+}
+
+EEPROMClass::EEPROMClass()
+{
+    mockEepromErase();
+}
+
+uint8_t EEPROMClass::read(int address)
+{
+    return cells[address % EEPROM_MOCK_SIZE];
+}
+
+void EEPROMClass::write(int address, uint8_t value)
+{
+    cells[address % EEPROM_MOCK_SIZE] = value;
+    cellWrites++;
+}
+
+void EEPROMClass::update(int address, uint8_t value)
+{
+    if (read(address) != value)
+        write(address, value);
+}
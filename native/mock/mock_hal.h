@@ -0,0 +1,42 @@
+#ifndef MOCK_HAL_H
+#define MOCK_HAL_H
+
+// Controls and counters for the host-side mocks. Include this from host
+// programs (benchmarks, simulators) rather than Arduino.h.
+
+#include <stdint.h>
+#include <string>
+
+// Virtual clock behind millis()/micros(). It only moves when told to, or
+// when powerSleep() sleeps until the next deadline.
+void mockAdvanceMicros(unsigned long micros);
+void mockAdvanceMillis(unsigned long millis);
+unsigned long mockNowMicros();
+
+// Pin levels read back by digitalRead()/analogRead()
+void mockSetDigital(uint8_t pin, uint8_t level);
+void mockSetAnalog(uint8_t pin, int value);
+
+// Everything printed or written to Serial, and bytes for it to read
+const std::string& mockSerialOutput();
+void mockSerialClear();
+void mockSerialInput(const std::string& bytes);
+
+// Bytes and transfers sent over I2C
+unsigned long mockTwiBytes();
+unsigned long mockTwiTransfers();
+
+// EEPROM cells actually changed by write()/update()
+unsigned long mockEepromWrites();
+void mockEepromErase();
+
+// What the next DHT11 reading returns, and whether it fails
+void mockDhtSet(uint8_t humidity, int16_t temperatureTenths);
+void mockDhtSetFailing(bool failing);
+
+// Time powerSleep() has skipped ahead, in milliseconds
+unsigned long mockPowerSleptMillis();
+
+void mockResetCounters();
+
+#endif
@@ -0,0 +1,78 @@
+#include "mock_hal.h"
+#include "power.h"
+
+// Stands in for power.cpp: sleeping moves the virtual clock straight to the
+// next deadline, which is what lets host programs run faster than real time.
+#define POWER_MAX_SLEEP_MILLIS 8000
+
+static unsigned long wakeMillis = POWER_MAX_SLEEP_MILLIS;
+static bool clocked = false;
+static unsigned long sleptMillis = 0;
+static unsigned long statsStartMillis = 0;
+
+unsigned long mockPowerSleptMillis()
+{
+    return sleptMillis;
+}
+
+void mockResetPower()
+{
+    sleptMillis = 0;
+    statsStartMillis = millis();
+}
+
+void powerBegin(void (*inputChanged)())
+{
+    (void)inputChanged;
+    mockResetPower();
+}
+
+void powerWakeWithin(unsigned long millisFromNow)
+{
+    if (millisFromNow < wakeMillis)
+        wakeMillis = millisFromNow;
+}
+
+void powerKeepClocked()
+{
+    clocked = true;
+}
+
+void powerSleep()
+{
+    unsigned long sleep = wakeMillis;
+
+    // Idle sleep only lasts until the next 1ms timer tick
+    if (clocked && sleep > 1)
+        sleep = 1;
+
+    wakeMillis = POWER_MAX_SLEEP_MILLIS;
+    clocked = false;
+
+    mockAdvanceMillis(sleep);
+    sleptMillis += sleep;
+}
+
+void powerSleepForAdc(unsigned int conversionMicros)
+{
+    (void)conversionMicros;
+}
+
+uint8_t powerAwakePercent()
+{
+    unsigned long total = millis() - statsStartMillis;
+
+    if (total < 100)
+        return 100;
+
+    return static_cast<uint8_t>(100 - min(sleptMillis / (total / 100), 100UL));
+}
+
+void powerResetStats()
+{
+    mockResetPower();
+}
+
+void powerPinChanged()
+{
+}
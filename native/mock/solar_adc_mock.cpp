@@ -0,0 +1,44 @@
+#include "mock_hal.h"
+#include "solar_adc.h"
+
+// Stands in for solar_adc.cpp: a block takes as long as on the device and
+// reads back whatever mockSetAnalog() gave the pin, scaled to 12 bits.
+#define SOLAR_ADC_MOCK_BLOCK_MILLIS 17
+
+static unsigned long startMillis = 0;
+static bool sampling = false;
+static bool ready = false;
+
+void solarAdcBegin()
+{
+    sampling = false;
+    ready = false;
+}
+
+void solarAdcStart()
+{
+    startMillis = millis();
+    sampling = true;
+    ready = false;
+}
+
+bool solarAdcBusy()
+{
+    if (sampling && millis() - startMillis >= SOLAR_ADC_MOCK_BLOCK_MILLIS)
+    {
+        sampling = false;
+        ready = true;
+    }
+
+    return sampling;
+}
+
+bool solarAdcRead(uint16_t& value)
+{
+    if (solarAdcBusy() || !ready)
+        return false;
+
+    ready = false;
+    value = static_cast<uint16_t>(analogRead(SOLAR_ADC_PIN)) << 2;
+    return true;
+}
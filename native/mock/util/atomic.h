@@ -0,0 +1,9 @@
+#ifndef ATOMIC_MOCK_H
+#define ATOMIC_MOCK_H
+
+// There are no interrupts on the host, an atomic block is just a block
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_FORCEON 1
+#define ATOMIC_BLOCK(type) for (int atomicOnce = 1; atomicOnce; atomicOnce = 0)
+
+#endif
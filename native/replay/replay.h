@@ -0,0 +1,16 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "mock_hal.h"
+#include <Arduino.h>
+
+#include "trace_log.h"
+
+// Feed the log's readings to the firmware, from replay_sensors.cpp. The
+// log has to outlive the replay.
+void replaySensorsBegin(const TraceLog& log);
+
+// True once every recorded reading has been taken.
+bool replaySensorsDone();
+
+#endif
@@ -0,0 +1,214 @@
+// Replays a trace from a -DTRACE_RECORD unit through the firmware on the
+// host: the recorded settings, sensor readings, detents and button events
+// go in at the millis() the unit took them, as fast as the host can run
+// the loop, and the fan duties that come out are diffed against the ones
+// the unit applied. Exits 1 when they differ.
+//
+// Capture the serial port from power up, then:
+// pio run -e native_replay && .pio/build/native_replay/program capture.bin
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+#include "replay.h"
+#include "button.h"
+#include "encoder.h"
+#include "power.h"
+#include "scheduler.h"
+
+// From src/main.cpp
+void setup();
+void loop();
+
+// How far apart the unit and the replay may switch a fan and still agree.
+// The unit's tasks take time to run, the replay's don't.
+#define REPLAY_TOLERANCE_MILLIS 50
+
+#define REPLAY_MAX_REPORTS 20
+
+static void storeSettings(const Settings& settings)
+{
+    // setup() reads them back from the store, as the unit did
+    mockEepromErase();
+    settingsSave(settings);
+
+    while (settingsUpdate())
+    {
+    }
+}
+
+static void applyInput(const TraceInput& input)
+{
+    if (input.steps != 0)
+    {
+        // Queues the detent and triggers the input task, like the interrupt
+        encoderMockDetent(input.steps);
+    }
+    else
+    {
+        // Queues the event and triggers the input task, like the tick
+        buttonMockEvent(static_cast<ButtonEvent>(input.button));
+    }
+}
+
+// Whether the unit had taken an input by now. At its own millis() it may
+// have come in after a pass that ran other tasks, the fans with the old
+// settings say, so wait until the replay has run as many.
+static bool inputDue(const TraceInput& input)
+{
+    if (input.millis != millis())
+        return timeReached(millis(), input.millis);
+
+    // Nothing more would run this millisecond without it
+    return schedulerPassesThisMillis() >= input.pass || schedulerMillisUntilNext() > 0;
+}
+
+static bool sameDuty(const FanState& a, const FanState& b)
+{
+    return memcmp(a.duty, b.duty, FAN_COUNT) == 0;
+}
+
+static void printDuty(const FanState& state)
+{
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+        printf(" %3u", state.duty[fan]);
+}
+
+// The duties in effect at a time, from a list of changes in time order
+static const FanState& stateAt(const std::vector<FanState>& changes, const FanState& initial, unsigned long millis)
+{
+    auto after = std::upper_bound(changes.begin(), changes.end(), millis,
+                                  [](unsigned long time, const FanState& change) { return time < change.millis; });
+
+    return (after == changes.begin()) ? initial : *(after - 1);
+}
+
+static unsigned long diffFans(const std::vector<FanState>& device, const std::vector<FanState>& replay)
+{
+    FanState off = FanState();
+    unsigned long mismatches = 0;
+
+    // Compare just after every change either side made, by then the other
+    // side should have made it too
+    std::vector<unsigned long> times;
+    for (const FanState& change : device)
+        times.push_back(change.millis + REPLAY_TOLERANCE_MILLIS);
+    for (const FanState& change : replay)
+        times.push_back(change.millis + REPLAY_TOLERANCE_MILLIS);
+
+    std::sort(times.begin(), times.end());
+    times.erase(std::unique(times.begin(), times.end()), times.end());
+
+    for (unsigned long time : times)
+    {
+        const FanState& expected = stateAt(device, off, time);
+        const FanState& actual = stateAt(replay, off, time);
+
+        if (sameDuty(expected, actual))
+            continue;
+
+        if (++mismatches <= REPLAY_MAX_REPORTS)
+        {
+            printf("%10.3fs  device", time / 1000.0);
+            printDuty(expected);
+            printf("  replay");
+            printDuty(actual);
+            printf("\n");
+        }
+    }
+
+    if (mismatches > REPLAY_MAX_REPORTS)
+        printf("... %lu more\n", mismatches - REPLAY_MAX_REPORTS);
+
+    return mismatches;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s capture.bin|-\n", argv[0]);
+        return 2;
+    }
+
+    FILE* file = (strcmp(argv[1], "-") == 0) ? stdin : fopen(argv[1], "rb");
+    if (file == nullptr)
+    {
+        perror(argv[1]);
+        return 2;
+    }
+
+    TraceLog log;
+    bool readable = traceLogRead(file, log);
+
+    if (file != stdin)
+        fclose(file);
+
+    if (!readable)
+        return 2;
+
+    printf("%lu frames, %lu lost, %lu CRC errors: %zu DHT, %zu solar, %zu input, %zu fan changes\n",
+           log.frames, log.lost, log.crcErrors, log.dht.size(), log.solar.size(), log.inputs.size(), log.fans.size());
+
+    if (log.lost > 0)
+        printf("frames were lost, the replay may part from the unit where they were\n");
+    if (log.rebooted)
+        printf("the unit restarted, replaying up to the restart\n");
+
+    // Start the clock where the unit's was when it sent the boot frame
+    storeSettings(log.settings);
+
+    if (millis() < log.boot.millis)
+        mockAdvanceMillis(log.boot.millis - millis());
+
+    replaySensorsBegin(log);
+    setup();
+
+    std::vector<FanState> replayed;
+    FanState last = FanState();
+    size_t nextInput = 0;
+
+    // Run until the last reading is in, then long enough for the fans to
+    // settle the way the unit's did
+    unsigned long end = log.fans.empty() ? 0 : log.fans.back().millis + REPLAY_TOLERANCE_MILLIS;
+
+    while (!replaySensorsDone() || nextInput < log.inputs.size() || millis() < end)
+    {
+        while (nextInput < log.inputs.size() && inputDue(log.inputs[nextInput]))
+            applyInput(log.inputs[nextInput++]);
+
+        // Wake for the next input rather than sleep past it
+        if (nextInput < log.inputs.size())
+            powerWakeWithin(log.inputs[nextInput].millis - millis());
+
+        loop();
+
+        FanState now;
+        now.millis = millis();
+
+        for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+            now.duty[fan] = fanOutputDuty(fan);
+
+        if (!sameDuty(now, last))
+        {
+            replayed.push_back(now);
+            last = now;
+        }
+
+        mockSerialClear();
+    }
+
+    printf("replayed %.1fs, %zu fan changes\n", (millis() - log.boot.millis) / 1000.0, replayed.size());
+
+    unsigned long mismatches = diffFans(log.fans, replayed);
+
+    if (mismatches > 0)
+    {
+        printf("%lu mismatches\n", mismatches);
+        return 1;
+    }
+
+    printf("fan duties match\n");
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include "replay.h"
+
+#include "dht11.h"
+#include "solar_adc.h"
+
+// Stand in for dht11.cpp and solar_adc.cpp, in place of their mocks. Every
+// reading or block the firmware starts finishes at the millis() the unit
+// took the next recorded one, and returns that.
+
+static const TraceLog* replayLog = nullptr;
+static size_t nextDht = 0;
+static size_t nextSolar = 0;
+
+static bool dhtStarted = false;
+static bool dhtCaptured = false;
+static bool solarStarted = false;
+
+void replaySensorsBegin(const TraceLog& log)
+{
+    replayLog = &log;
+    nextDht = 0;
+    nextSolar = 0;
+    dhtStarted = false;
+    dhtCaptured = false;
+    solarStarted = false;
+}
+
+bool replaySensorsDone()
+{
+    return nextDht >= replayLog->dht.size() && nextSolar >= replayLog->solar.size();
+}
+
+static bool dhtDue()
+{
+    return nextDht < replayLog->dht.size() && millis() >= replayLog->dht[nextDht].millis;
+}
+
+static bool solarDue()
+{
+    return nextSolar < replayLog->solar.size() && millis() >= replayLog->solar[nextSolar].millis;
+}
+
+void dhtBegin()
+{
+    dhtStarted = false;
+    dhtCaptured = false;
+}
+
+bool dhtStartReading()
+{
+    if (dhtStarted)
+        return false;
+
+    dhtStarted = true;
+    return true;
+}
+
+void dhtUpdate()
+{
+    // Past the end of the trace a reading never finishes
+    if (dhtStarted && dhtDue())
+        dhtCaptured = true;
+}
+
+bool dhtBusy()
+{
+    return dhtStarted && !dhtCaptured;
+}
+
+bool dhtReadSample(DhtSample& sample)
+{
+    if (!dhtCaptured)
+        return false;
+
+    sample.humidity = replayLog->dht[nextDht].humidity;
+    sample.temperatureTenths = replayLog->dht[nextDht].temperatureTenths;
+
+    nextDht++;
+    dhtStarted = false;
+    dhtCaptured = false;
+    return true;
+}
+
+bool dhtWaitForSample(DhtSample& sample, uint16_t timeoutMillis)
+{
+    // setup() takes the first reading whenever the unit got it, as long as
+    // that was before it gave up. Otherwise it's updateDHT()'s.
+    if (nextDht >= replayLog->dht.size() || replayLog->dht[nextDht].millis > millis() + timeoutMillis)
+        return false;
+
+    if (millis() < replayLog->dht[nextDht].millis)
+        mockAdvanceMillis(replayLog->dht[nextDht].millis - millis());
+
+    dhtStarted = true;
+    dhtUpdate();
+    return dhtReadSample(sample);
+}
+
+void dhtPinChanged()
+{
+}
+
+uint16_t dhtErrorCount()
+{
+    return 0;
+}
+
+void solarAdcBegin()
+{
+    solarStarted = false;
+}
+
+void solarAdcStart()
+{
+    solarStarted = true;
+}
+
+bool solarAdcBusy()
+{
+    return solarStarted && !solarDue();
+}
+
+bool solarAdcRead(uint16_t& value)
+{
+    if (!solarStarted || !solarDue())
+        return false;
+
+    value = replayLog->solar[nextSolar].reading;
+
+    nextSolar++;
+    solarStarted = false;
+    return true;
+}
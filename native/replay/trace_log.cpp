@@ -0,0 +1,151 @@
+#include "trace_log.h"
+
+#include <string.h>
+
+#include "crc.h"
+
+#define MAX_PAYLOAD 255
+
+static bool addFrame(TraceLog& log, uint8_t type, const uint8_t* payload, uint8_t length)
+{
+    // Nothing before the boot frame can be replayed, nothing after the next
+    if (type == TELEMETRY_TRACE_BOOT)
+    {
+        if (log.booted)
+        {
+            log.rebooted = true;
+            return false;
+        }
+
+        if (length < sizeof(TraceBoot))
+            return true;
+
+        // The settings record is as long as the build has fans
+        memcpy(&log.boot, payload, sizeof(TraceBoot));
+
+        if (log.boot.fanCount != FAN_COUNT || length != sizeof(TraceBoot) + sizeof(Settings))
+            return false;
+
+        memcpy(&log.settings, payload + sizeof(TraceBoot), sizeof(Settings));
+        log.booted = true;
+        return true;
+    }
+
+    if (!log.booted)
+        return true;
+
+    switch (type)
+    {
+        case TELEMETRY_TRACE_DHT:
+            if (length == sizeof(TraceDht))
+            {
+                TraceDht dht;
+                memcpy(&dht, payload, sizeof(dht));
+                log.dht.push_back(dht);
+            }
+            break;
+
+        case TELEMETRY_TRACE_SOLAR:
+            if (length == sizeof(TraceSolar))
+            {
+                TraceSolar solar;
+                memcpy(&solar, payload, sizeof(solar));
+                log.solar.push_back(solar);
+            }
+            break;
+
+        case TELEMETRY_TRACE_INPUT:
+            if (length == sizeof(TraceInput))
+            {
+                TraceInput input;
+                memcpy(&input, payload, sizeof(input));
+                log.inputs.push_back(input);
+            }
+            break;
+
+        case TELEMETRY_TRACE_FANS:
+            if (length == sizeof(TraceFans) + FAN_COUNT)
+            {
+                TraceFans header;
+                memcpy(&header, payload, sizeof(header));
+
+                FanState fans;
+                fans.millis = header.millis;
+                memcpy(fans.duty, payload + sizeof(header), FAN_COUNT);
+                log.fans.push_back(fans);
+            }
+            break;
+    }
+
+    return true;
+}
+
+bool traceLogRead(FILE* file, TraceLog& log)
+{
+    log = TraceLog();
+
+    std::vector<uint8_t> bytes;
+    uint8_t chunk[4096];
+    size_t count;
+
+    while ((count = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        bytes.insert(bytes.end(), chunk, chunk + count);
+
+    // Frames are found by their sync bytes and kept if the CRC agrees, the
+    // same as tools/telemetry_decode.py. Text in between is skipped.
+    bool sequenced = false;
+    uint16_t lastSequence = 0;
+    size_t i = 0;
+
+    while (i + TELEMETRY_HEADER_SIZE + TELEMETRY_CRC_SIZE <= bytes.size())
+    {
+        if (bytes[i] != TELEMETRY_SYNC1 || bytes[i + 1] != TELEMETRY_SYNC2)
+        {
+            i++;
+            continue;
+        }
+
+        const uint8_t* header = &bytes[i + 2];
+        uint8_t type = header[0];
+        uint8_t length = header[1];
+        uint16_t sequence = header[2] | (header[3] << 8);
+        size_t end = i + TELEMETRY_HEADER_SIZE + length + TELEMETRY_CRC_SIZE;
+
+        if (end > bytes.size())
+            break;
+
+        uint16_t crc = 0xFFFF;
+        for (size_t j = i + 2; j < end - TELEMETRY_CRC_SIZE; j++)
+            crc = crc16Update(crc, bytes[j]);
+
+        if (crc != (bytes[end - 2] | (bytes[end - 1] << 8)))
+        {
+            log.crcErrors++;
+            i++;
+            continue;
+        }
+
+        if (sequenced)
+            log.lost += static_cast<uint16_t>(sequence - lastSequence - 1);
+        sequenced = true;
+        lastSequence = sequence;
+        log.frames++;
+
+        if (!addFrame(log, type, header + 4, length))
+            break;
+
+        i = end;
+    }
+
+    if (!log.booted)
+    {
+        if (log.boot.fanCount != 0)
+            fprintf(stderr, "trace is from a %u fan build, this replay has %u\n", log.boot.fanCount, FAN_COUNT);
+        else
+            fprintf(stderr, "no boot frame, capture from power up with a -DTRACE_RECORD build\n");
+
+        return false;
+    }
+
+    return true;
+}
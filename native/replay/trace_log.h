@@ -0,0 +1,44 @@
+#ifndef TRACE_LOG_H
+#define TRACE_LOG_H
+
+// A capture of a -DTRACE_RECORD unit's serial output, split into the
+// trace frames replay needs. Status frames and text are skipped.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#include "fan_output.h"
+#include "settings_store.h"
+#include "telemetry.h"
+
+// Fan duties from a TELEMETRY_TRACE_FANS frame, or as the replay applied them
+struct FanState
+{
+    unsigned long millis;
+    uint8_t duty[FAN_COUNT];
+};
+
+struct TraceLog
+{
+    bool booted;
+    TraceBoot boot;
+    Settings settings;
+
+    // In the order the unit took them
+    std::vector<TraceDht> dht;
+    std::vector<TraceSolar> solar;
+    std::vector<TraceInput> inputs;
+    std::vector<FanState> fans;
+
+    unsigned long frames;
+    unsigned long lost;         // Gaps in the sequence numbers
+    unsigned long crcErrors;
+    bool rebooted;              // Another boot frame, everything after it is ignored
+};
+
+// Read a whole capture. Returns false with a message on stderr when it
+// can't be replayed: no boot frame, or built for another fan count.
+bool traceLogRead(FILE* file, TraceLog& log);
+
+#endif
@@ -0,0 +1,84 @@
+#include "plant.h"
+
+#include <math.h>
+
+#define SECONDS_PER_DAY 86400.0
+
+// Clouds drift back towards the day's cloudiness over about half an hour
+#define CLOUD_SETTLE_SECONDS 1800.0
+#define CLOUD_NOISE 0.02
+
+// Share of the sun a full overcast still lets through
+#define OVERCAST_SOLAR 0.25
+
+// Plants keep transpiring a little in the dark
+#define NIGHT_TRANSPIRATION 0.2
+
+double saturationMoisture(double celsius)
+{
+    // Cubic fit, good to a few percent from 0 to 50C
+    return 5.018 + 0.32321 * celsius + 8.1847e-3 * celsius * celsius + 3.1243e-4 * celsius * celsius * celsius;
+}
+
+Plant::Plant(const Weather& weather, const Greenhouse& house, uint32_t seed) :
+    weather(weather), house(house), random(seed ? seed : 1), clock(0)
+{
+    cloud = weather.cloudiness;
+    temperature = outsideCelsius();
+    moisture = saturationMoisture(weather.meanCelsius) * weather.outsideHumidity / 100;
+    solar = 0;
+}
+
+void Plant::step(double seconds, double airflow)
+{
+    // Clouds wander around the day's cloudiness
+    cloud += (weather.cloudiness - cloud) * seconds / CLOUD_SETTLE_SECONDS;
+    cloud += (nextRandom() - 0.5) * CLOUD_NOISE * sqrt(seconds);
+    cloud = fmin(1, fmax(0, cloud));
+
+    solar = weather.peakSolar * sunElevation() * (1 - (1 - OVERCAST_SOLAR) * cloud);
+
+    // Heat in from the sun, out through the glazing and with the fan air
+    double exchange = house.lossPerSecond + house.fanAirChanges * airflow;
+    double outside = outsideCelsius();
+    temperature += (house.solarGainCelsius * solar - exchange * (temperature - outside)) * seconds;
+
+    // Water in from the plants, out with the air the fans change
+    double outsideMoisture = saturationMoisture(weather.meanCelsius) * weather.outsideHumidity / 100;
+    double transpiration = house.transpiration * (NIGHT_TRANSPIRATION + solar);
+    moisture += (transpiration - exchange * (moisture - outsideMoisture)) * seconds;
+
+    // Anything over saturation condenses out
+    moisture = fmin(moisture, saturationMoisture(temperature));
+
+    clock += seconds;
+}
+
+double Plant::humidityPercent() const
+{
+    return fmin(100, 100 * moisture / saturationMoisture(temperature));
+}
+
+double Plant::outsideCelsius() const
+{
+    // Warmest at 15:00, coldest at 03:00
+    double phase = 2 * M_PI * (clock / SECONDS_PER_DAY - 9.0 / 24);
+    return weather.meanCelsius + weather.swingCelsius * sin(phase);
+}
+
+double Plant::sunElevation() const
+{
+    // Up from 06:00 to 18:00, highest at noon
+    double hour = fmod(clock / 3600, 24);
+    return (hour > 6 && hour < 18) ? sin(M_PI * (hour - 6) / 12) : 0;
+}
+
+double Plant::nextRandom()
+{
+    // xorshift32, the same sequence for the same seed on every host
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+
+    return random / 4294967296.0;
+}
@@ -0,0 +1,63 @@
+#ifndef PLANT_H
+#define PLANT_H
+
+// Greenhouse plant model for the simulator: one well mixed air volume
+// heated by the sun, losing heat through the glazing and to the fans, with
+// the plants transpiring into it. Deliberately simple, it's there to tell
+// policies apart rather than to predict a real house.
+
+#include <stdint.h>
+
+// The weather outside, repeated every day
+struct Weather
+{
+    const char* name;
+    double meanCelsius;         // Outside air, daily mean
+    double swingCelsius;        // Half the day to night range, warmest at 15:00
+    double outsideHumidity;     // Percent, outside air at the mean temperature
+    double cloudiness;          // 0 clear to 1 overcast, varied minute to minute
+    double peakSolar;           // 0 to 1, sensor reading at clear noon
+};
+
+// Fixed properties of the house
+struct Greenhouse
+{
+    double solarGainCelsius;    // Warming per second in full sun with no losses
+    double lossPerSecond;       // Fraction of the inside/outside difference lost each second
+    double fanAirChanges;       // The same for all fans at full speed together
+    double transpiration;       // Water added per second in full sun, g/m3
+};
+
+class Plant
+{
+public:
+    Plant(const Weather& weather, const Greenhouse& house, uint32_t seed);
+
+    // Advance by seconds with the fans moving this fraction of their full
+    // combined airflow.
+    void step(double seconds, double airflow);
+
+    double temperatureCelsius() const { return temperature; }
+    double humidityPercent() const;
+    double solarFraction() const { return solar; }
+
+private:
+    double outsideCelsius() const;
+    double sunElevation() const;
+    double nextRandom();
+
+    Weather weather;
+    Greenhouse house;
+    uint32_t random;
+
+    double clock;           // Seconds since midnight on day one
+    double temperature;     // Celsius
+    double moisture;        // g/m3
+    double cloud;           // 0 to 1, follows a random walk
+    double solar;           // 0 to 1, as the light sensor sees it
+};
+
+// Water held by saturated air, g/m3
+double saturationMoisture(double celsius);
+
+#endif
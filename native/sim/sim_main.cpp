@@ -0,0 +1,309 @@
+// Greenhouse simulator: the firmware's own loop, sensors and fan control,
+// run against the plant model in plant.cpp for days of virtual time. Every
+// scenario is one weather with one policy (the settings a user would
+// enter), and the report compares the policies on the same weather.
+//
+// The firmware keeps its state in globals, so scenarios can't share a
+// process. Each one runs in a forked child from a clean copy and sends its
+// totals back over a pipe, as many at a time as there are CPUs.
+//
+// pio run -e native_sim && .pio/build/native_sim/program [days]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "mock_hal.h"
+#include <Arduino.h>
+#include "fan_output.h"
+#include "settings_store.h"
+
+#include "plant.h"
+
+// From src/main.cpp
+void setup();
+void loop();
+
+#define SOLAR_PIN A0
+
+#define SIM_DAYS 3
+#define SIM_STEP_MILLIS 1000        // Plant and sensors move on this often
+#define SIM_MAX_SUBSTEP 10.0        // Seconds, longer sleeps are integrated in pieces
+#define SIM_SEED 20240601
+
+// Power drawn by one fan at full speed. Fan power goes roughly with the
+// cube of the speed, and the speed roughly with the duty.
+#define FAN_WATTS 12.0
+
+// Options as main.cpp numbers them
+#define FAN_OFF 0
+#define FAN_ON 1
+#define FAN_AUTO 2
+#define POWER_OFF 0
+#define POWER_ON 1
+#define POWER_SOLAR 2
+
+struct Policy
+{
+    const char* name;
+    uint8_t temperature;    // Fahrenheit
+    uint8_t humidity;
+    uint8_t solar;
+    uint8_t fanOption;      // For every fan
+    uint8_t power;
+};
+
+// Totals over the whole run, sent back from the child as they are
+struct Result
+{
+    bool ok;
+    double fanSeconds;          // Some fan running
+    double fanFullSeconds;      // Fan time at full speed, summed over the fans
+    double energyWh;
+    double maxOverFahrenheit;   // Worst temperature over the set point
+    double degreeHoursOver;
+    double maxOverHumidity;     // Worst humidity over the set point, percent
+    double percentHoursOver;
+    double meanFahrenheit;
+    unsigned long switches;     // Fans turning on or off
+};
+
+static const Weather weathers[] =
+{
+    { "clear summer", 24, 8, 55, 0.1, 0.95 },
+    { "humid overcast", 20, 4, 85, 0.8, 0.9 },
+    { "cool spring", 12, 7, 60, 0.3, 0.85 }
+};
+
+static const Policy policies[] =
+{
+    { "auto", 78, 85, 30, FAN_AUTO, POWER_ON },
+    { "auto solar", 78, 85, 30, FAN_AUTO, POWER_SOLAR },
+    { "auto 72F/70%", 72, 70, 30, FAN_AUTO, POWER_ON },
+    { "on solar", 78, 85, 30, FAN_ON, POWER_SOLAR }
+};
+
+static const Greenhouse house = { 0.01, 1.0 / 1800, 1.0 / 60, 0.004 };
+
+#define WEATHER_COUNT (sizeof(weathers) / sizeof(weathers[0]))
+#define POLICY_COUNT (sizeof(policies) / sizeof(policies[0]))
+#define SCENARIO_COUNT (WEATHER_COUNT * POLICY_COUNT)
+
+static double toFahrenheit(double celsius)
+{
+    return celsius * 9 / 5 + 32;
+}
+
+static void showSensors(const Plant& plant)
+{
+    long humidity = lround(plant.humidityPercent());
+    mockDhtSet(static_cast<uint8_t>(constrain(humidity, 0L, 100L)), static_cast<int16_t>(lround(plant.temperatureCelsius() * 10)));
+    mockSetAnalog(SOLAR_PIN, static_cast<int>(lround(plant.solarFraction() * 1023)));
+}
+
+static void storePolicy(const Policy& policy)
+{
+    Settings settings;
+
+    settings.temperature = policy.temperature;
+    settings.humidity = policy.humidity;
+    settings.solar = policy.solar;
+
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+        settings.fans[fan] = policy.fanOption;
+
+    settings.power = policy.power;
+
+    // setup() picks it up from the store like the user had saved it
+    mockEepromErase();
+    settingsSave(settings);
+
+    while (settingsUpdate())
+        mockAdvanceMillis(4);
+}
+
+static Result runScenario(const Weather& weather, const Policy& policy, double days)
+{
+    Result result = Result();
+    Plant plant(weather, house, SIM_SEED);
+
+    storePolicy(policy);
+    showSensors(plant);
+    setup();
+
+    const double totalSeconds = days * 86400;
+    double seconds = 0;
+    double fahrenheitSeconds = 0;
+    unsigned long lastMillis = millis();
+    uint16_t lastMask = fanOutputMask();
+
+    while (seconds < totalSeconds)
+    {
+        loop();
+
+        // Count every fan that turned on or off, however briefly
+        uint16_t mask = fanOutputMask();
+        for (uint16_t changed = mask ^ lastMask; changed; changed &= changed - 1)
+            result.switches++;
+        lastMask = mask;
+
+        unsigned long now = millis();
+        if (now - lastMillis < SIM_STEP_MILLIS)
+            continue;
+
+        double elapsed = (now - lastMillis) / 1000.0;
+        lastMillis = now;
+
+        // The duties held through the step, as the plant saw them
+        double airflow = 0;
+        double watts = 0;
+        for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+        {
+#ifdef FAN_SHIFT_REGISTER
+            // A relay runs flat out whatever duty it was given
+            double speed = (mask & (1U << fan)) ? 1.0 : 0.0;
+#else
+            double speed = fanOutputDuty(fan) / static_cast<double>(FAN_DUTY_MAX);
+#endif
+            airflow += speed / FAN_COUNT;
+            watts += FAN_WATTS * speed * speed * speed;
+            result.fanFullSeconds += speed * elapsed;
+        }
+
+        if (mask)
+            result.fanSeconds += elapsed;
+        result.energyWh += watts * elapsed / 3600;
+
+        for (double left = elapsed; left > 0; left -= SIM_MAX_SUBSTEP)
+            plant.step(fmin(left, SIM_MAX_SUBSTEP), airflow);
+
+        double over = toFahrenheit(plant.temperatureCelsius()) - policy.temperature;
+        result.maxOverFahrenheit = fmax(result.maxOverFahrenheit, over);
+        result.degreeHoursOver += fmax(0, over) * elapsed / 3600;
+
+        double humidityOver = plant.humidityPercent() - policy.humidity;
+        result.maxOverHumidity = fmax(result.maxOverHumidity, humidityOver);
+        result.percentHoursOver += fmax(0, humidityOver) * elapsed / 3600;
+
+        fahrenheitSeconds += toFahrenheit(plant.temperatureCelsius()) * elapsed;
+        seconds += elapsed;
+
+        showSensors(plant);
+
+        // Telemetry piles up in the serial mock otherwise
+        mockSerialClear();
+    }
+
+    result.meanFahrenheit = fahrenheitSeconds / seconds;
+    result.ok = true;
+
+    return result;
+}
+
+static pid_t startScenario(size_t scenario, double days, int& readFd)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return -1;
+
+    fflush(stdout);
+    pid_t pid = fork();
+
+    if (pid == 0)
+    {
+        close(fds[0]);
+
+        const Weather& weather = weathers[scenario / POLICY_COUNT];
+        const Policy& policy = policies[scenario % POLICY_COUNT];
+        Result result = runScenario(weather, policy, days);
+
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == static_cast<ssize_t>(sizeof(result)) ? 0 : 1);
+    }
+
+    close(fds[1]);
+
+    if (pid < 0)
+    {
+        close(fds[0]);
+        return -1;
+    }
+
+    readFd = fds[0];
+    return pid;
+}
+
+int main(int argc, char** argv)
+{
+    double days = (argc > 1) ? atof(argv[1]) : SIM_DAYS;
+    if (days <= 0)
+    {
+        fprintf(stderr, "usage: %s [days]\n", argv[0]);
+        return 2;
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t parallel = (cpus > 0) ? static_cast<size_t>(cpus) : 1;
+
+    int fds[SCENARIO_COUNT];
+    Result results[SCENARIO_COUNT];
+    size_t running = 0;
+
+    // Keep every CPU busy, the results are read once all have finished.
+    // Each child writes less than a pipe holds, so none of them blocks.
+    for (size_t scenario = 0; scenario < SCENARIO_COUNT; scenario++)
+    {
+        if (running == parallel && wait(nullptr) > 0)
+            running--;
+
+        if (startScenario(scenario, days, fds[scenario]) < 0)
+        {
+            perror("fork");
+            return 1;
+        }
+
+        running++;
+    }
+
+    while (wait(nullptr) > 0)
+    {
+    }
+
+    for (size_t scenario = 0; scenario < SCENARIO_COUNT; scenario++)
+    {
+        if (read(fds[scenario], &results[scenario], sizeof(Result)) != static_cast<ssize_t>(sizeof(Result)))
+            results[scenario].ok = false;
+
+        close(fds[scenario]);
+    }
+
+    printf("%g days, %d fans of %.0fW\n", days, FAN_COUNT, FAN_WATTS);
+
+    for (size_t scenario = 0; scenario < SCENARIO_COUNT; scenario++)
+    {
+        if (scenario % POLICY_COUNT == 0)
+        {
+            printf("\n%s\n", weathers[scenario / POLICY_COUNT].name);
+            printf("%-14s %8s %8s %8s %8s %8s %8s %8s %8s %8s\n", "policy", "fan h", "full h", "Wh",
+                   "mean F", "over F", "F h", "over RH", "RH h", "switches");
+        }
+
+        const Result& result = results[scenario];
+        const char* name = policies[scenario % POLICY_COUNT].name;
+
+        if (!result.ok)
+        {
+            printf("%-14s failed\n", name);
+            continue;
+        }
+
+        printf("%-14s %8.1f %8.1f %8.0f %8.1f %8.1f %8.1f %8.0f %8.0f %8lu\n", name,
+               result.fanSeconds / 3600, result.fanFullSeconds / 3600, result.energyWh,
+               result.meanFahrenheit, result.maxOverFahrenheit, result.degreeHoursOver,
+               result.maxOverHumidity, result.percentHoursOver, result.switches);
+    }
+
+    return 0;
+}
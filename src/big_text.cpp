@@ -0,0 +1,32 @@
+#include "big_text.h"
+
+#include "big_glyphs.h"
+
+static_assert(BIG_GLYPH_PAGES * 8 == BIG_TEXT_HEIGHT, "Glyphs must fill whole pages");
+static_assert(BIG_GLYPH_WIDTH + BIG_TEXT_GAP == BIG_TEXT_ADVANCE, "Advance is a glyph and a gap");
+
+static const uint8_t* findBigGlyph(char c)
+{
+    for (uint8_t i = 0; i < sizeof(bigGlyphCharacters) - 1; i++)
+    {
+        if (static_cast<char>(pgm_read_byte(bigGlyphCharacters + i)) == c)
+            return bigGlyphs[i];
+    }
+
+    return nullptr;
+}
+
+void drawBigText(PageDisplay& display, int16_t x, uint8_t topPage, const char* text)
+{
+    // Nothing to copy unless this pass is drawing one of the text's pages
+    if (!display.drawingPages(topPage, BIG_GLYPH_PAGES))
+        return;
+
+    for (; *text; text++, x += BIG_TEXT_ADVANCE)
+    {
+        const uint8_t* glyph = findBigGlyph(*text);
+
+        if (glyph)
+            display.drawPageBitmap(x, topPage, glyph, BIG_GLYPH_WIDTH, BIG_GLYPH_PAGES);
+    }
+}
@@ -0,0 +1,183 @@
+#include "button.h"
+
+#include "spsc_queue.h"
+
+// The push button is D4 / PD4 on PCINT20, pulled up and LOW while pressed
+#define BUTTON_PIN 4
+#define BUTTON_BIT _BV(4)
+#define BUTTON_PCINT_BIT _BV(PCINT20)
+
+// Timer2 runs free at F_CPU/32 (set up the same way by dht11.cpp), the
+// compare B match comes round once per overflow
+#define BUTTON_TICK_MICROS 512
+
+// The level has to hold this long before it counts
+#define BUTTON_DEBOUNCE_TICKS (20000 / BUTTON_TICK_MICROS)
+
+// Held this long is a long press. A press is only sent once this long has
+// passed after the release without a second press, which makes it a double.
+#define BUTTON_LONG_TICKS (1000000UL / BUTTON_TICK_MICROS)
+#define BUTTON_DOUBLE_TICKS (300000UL / BUTTON_TICK_MICROS)
+
+#define BUTTON_QUEUE_SIZE 8
+
+static SpscQueue<ButtonEvent, BUTTON_QUEUE_SIZE> buttonEvents;
+static volatile uint8_t buttonDropped = 0;
+static void (*buttonEvent)() = nullptr;
+
+static void buttonPush(ButtonEvent event)
+{
+    if (!buttonEvents.push(event))
+    {
+        if (buttonDropped < 0xFF)
+            buttonDropped++;
+    }
+
+    if (buttonEvent != nullptr)
+        buttonEvent();
+}
+
+#ifdef __AVR__
+
+enum ButtonState : uint8_t
+{
+    BUTTON_IDLE,
+    BUTTON_DOWN,        // Pressed once, timing for a long press
+    BUTTON_RELEASED,    // Released once, timing for a second press
+    BUTTON_HELD         // Long or double press sent, waiting for the release
+};
+
+// Only touched from the pin change and Timer2 interrupts, which never nest
+static ButtonState buttonState = BUTTON_IDLE;
+static bool buttonPressed = false;      // The debounced level
+static uint8_t buttonLastLevel = BUTTON_BIT;    // The pin as the last edge left it
+static uint8_t buttonSettleTicks = 0;
+static uint16_t buttonStateTicks = 0;
+
+static void buttonEnter(ButtonState state)
+{
+    buttonState = state;
+    buttonStateTicks = 0;
+}
+
+static void buttonSettled(bool pressed)
+{
+    buttonPressed = pressed;
+
+    if (pressed)
+    {
+        if (buttonState == BUTTON_IDLE)
+            buttonEnter(BUTTON_DOWN);
+        else if (buttonState == BUTTON_RELEASED)
+        {
+            buttonPush(BUTTON_DOUBLE_PRESS);
+            buttonEnter(BUTTON_HELD);
+        }
+    }
+    else
+    {
+        if (buttonState == BUTTON_DOWN)
+            buttonEnter(BUTTON_RELEASED);
+        else if (buttonState == BUTTON_HELD)
+            buttonEnter(BUTTON_IDLE);
+    }
+}
+
+ISR(TIMER2_COMPB_vect)
+{
+    // Debounce, then time the gesture the settled level is part of
+    if (buttonSettleTicks > 0 && --buttonSettleTicks == 0)
+    {
+        bool pressed = !(PIND & BUTTON_BIT);
+
+        if (pressed != buttonPressed)
+            buttonSettled(pressed);
+    }
+
+    buttonStateTicks++;
+
+    if (buttonState == BUTTON_DOWN && buttonStateTicks >= BUTTON_LONG_TICKS)
+    {
+        buttonPush(BUTTON_LONG_PRESS);
+        buttonEnter(BUTTON_HELD);
+    }
+    else if (buttonState == BUTTON_RELEASED && buttonStateTicks >= BUTTON_DOUBLE_TICKS)
+    {
+        buttonPush(BUTTON_PRESS);
+        buttonEnter(BUTTON_IDLE);
+    }
+
+    // Nothing left to time until the next edge
+    if (buttonState == BUTTON_IDLE && buttonSettleTicks == 0)
+        TIMSK2 &= ~_BV(OCIE2B);
+}
+
+#endif
+
+void buttonBegin(void (*onEvent)())
+{
+    buttonEvent = onEvent;
+
+#ifdef __AVR__
+    pinMode(BUTTON_PIN, INPUT_PULLUP);
+    buttonLastLevel = PIND & BUTTON_BIT;
+
+    // Timer2 in normal mode, counting freely at F_CPU/32. The tick is only
+    // enabled while there's something to time.
+    TCCR2A = 0;
+    TCCR2B = _BV(CS21) | _BV(CS20);
+    TIMSK2 &= ~_BV(OCIE2B);
+
+    // The button stays armed in every sleep mode, it's also a wake source
+    PCMSK2 |= BUTTON_PCINT_BIT;
+    PCICR |= _BV(PCIE2);
+#endif
+}
+
+void buttonPinChanged()
+{
+#ifdef __AVR__
+    // The vector is shared with the DHT11 and the wake pins, only edges on
+    // the button itself count
+    uint8_t level = PIND & BUTTON_BIT;
+    if (level == buttonLastLevel)
+        return;
+
+    buttonLastLevel = level;
+
+    // Every edge, bounces included, restarts the settling time
+    buttonSettleTicks = BUTTON_DEBOUNCE_TICKS;
+
+    if (!(TIMSK2 & _BV(OCIE2B)))
+    {
+        TIFR2 = _BV(OCF2B);
+        TIMSK2 |= _BV(OCIE2B);
+    }
+#endif
+}
+
+bool buttonReadEvent(ButtonEvent& event)
+{
+    return buttonEvents.pop(event);
+}
+
+bool buttonBusy()
+{
+#ifdef __AVR__
+    return TIMSK2 & _BV(OCIE2B);
+#else
+    return false;
+#endif
+}
+
+uint8_t buttonDroppedCount()
+{
+    return buttonDropped;
+}
+
+#ifndef __AVR__
+void buttonMockEvent(ButtonEvent event)
+{
+    buttonPush(event);
+}
+#endif
@@ -0,0 +1,275 @@
+#include "dht11.h"
+
+#include <util/atomic.h>
+
+// The DHT11 data line is D7, which is PD7 / PCINT23
+#define DHT_DDR DDRD
+#define DHT_PORT PORTD
+#define DHT_INPUT PIND
+#define DHT_BIT _BV(PD7)
+#define DHT_PCINT_BIT _BV(PCINT23)
+
+// Host pulls the line low this long to request a reading
+#define DHT_START_MILLIS 20
+
+// A full response takes about 5ms, give up after this
+#define DHT_TIMEOUT_MILLIS 10
+
+// The DHT11 needs to rest at least a second between readings
+#define DHT_MIN_INTERVAL_MILLIS 1000
+
+// Timer2 runs free at F_CPU/32, 2us per tick at 16MHz
+#define DHT_TICK_MICROS 2
+
+// Each bit is a 50us low followed by a 26us (0) or 70us (1) high, so the time
+// between falling edges is ~76us for a 0 and ~120us for a 1.
+#define DHT_ONE_TICKS (100 / DHT_TICK_MICROS)
+
+// Falling edge 0 is the sensor response, edge 1 starts the first bit and
+// every edge after that ends a bit.
+#define DHT_FIRST_DATA_EDGE 2
+#define DHT_BITS 40
+#define DHT_BYTES (DHT_BITS / 8)
+
+enum dhtStateType
+{
+    DHT_IDLE,
+    DHT_START,
+    DHT_READING
+};
+
+static dhtStateType dhtState = DHT_IDLE;
+static unsigned long dhtStateTime = 0;
+static unsigned long dhtLastStart = 0;
+static bool dhtStarted = false;
+static uint16_t dhtErrors = 0;
+
+static DhtSample dhtLatest;
+static bool dhtLatestReady = false;
+
+// Shared with the pin change interrupt
+static volatile uint8_t dhtData[DHT_BYTES];
+static volatile uint8_t dhtEdges = 0;
+static volatile uint8_t dhtLastEdge = 0;
+static volatile uint8_t dhtLastLevel = DHT_BIT;
+
+void dhtPinChanged()
+{
+    // The vector is shared, ignore it unless a reading is being captured
+    if (!(PCMSK2 & DHT_PCINT_BIT))
+        return;
+
+    // The button and wake pins share the vector, so only a change of this
+    // pin counts. Bits are measured between falling edges only. An edge
+    // missed this way leaves the reading short and it times out.
+    uint8_t level = DHT_INPUT & DHT_BIT;
+    if (level == dhtLastLevel)
+        return;
+
+    dhtLastLevel = level;
+
+    if (level)
+        return;
+
+    uint8_t now = TCNT2;
+    uint8_t ticks = now - dhtLastEdge;
+    dhtLastEdge = now;
+
+    uint8_t edge = dhtEdges++;
+
+    if (edge < DHT_FIRST_DATA_EDGE)
+        return;
+
+    // Shift the bit in, most significant bit first
+    uint8_t bit = edge - DHT_FIRST_DATA_EDGE;
+    uint8_t index = bit >> 3;
+    dhtData[index] = (dhtData[index] << 1) | (ticks > DHT_ONE_TICKS ? 1 : 0);
+
+    // Stop listening once the last bit is in
+    if (bit == DHT_BITS - 1)
+        PCMSK2 &= ~DHT_PCINT_BIT;
+}
+
+static void dhtStopCapture()
+{
+    PCMSK2 &= ~DHT_PCINT_BIT;
+
+    // Leave the line released and pulled up between readings
+    DHT_DDR &= ~DHT_BIT;
+    DHT_PORT |= DHT_BIT;
+}
+
+static bool dhtDecode(DhtSample& sample)
+{
+    uint8_t bytes[DHT_BYTES];
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        for (uint8_t i = 0; i < DHT_BYTES; i++)
+            bytes[i] = dhtData[i];
+    }
+
+    // A disconnected sensor reads all zeros, which still passes the checksum
+    uint8_t sum = bytes[0] + bytes[1] + bytes[2] + bytes[3];
+    if (sum != bytes[4] || sum == 0)
+        return false;
+
+    // Reject readings outside what the DHT11 can report
+    if (bytes[0] > 100)
+        return false;
+
+    // Newer DHT11 parts report tenths of a degree, with bit 7 as the sign
+    int16_t tenths = static_cast<int16_t>(bytes[2]) * 10 + (bytes[3] & 0x0F);
+    if (bytes[3] & 0x80)
+        tenths = -tenths;
+
+    sample.humidity = bytes[0];
+    sample.temperatureTenths = tenths;
+
+    return true;
+}
+
+void dhtBegin()
+{
+    // Timer2 in normal mode, counting freely at F_CPU/32
+    TCCR2A = 0;
+    TCCR2B = _BV(CS21) | _BV(CS20);
+
+    // Enable the pin change interrupt group, the pin itself is masked per reading
+    PCMSK2 &= ~DHT_PCINT_BIT;
+    PCICR |= _BV(PCIE2);
+
+    dhtStopCapture();
+
+    dhtState = DHT_IDLE;
+    dhtStarted = false;
+    dhtLatestReady = false;
+}
+
+bool dhtStartReading()
+{
+    if (dhtState != DHT_IDLE)
+        return false;
+
+    if (dhtStarted && millis() - dhtLastStart < DHT_MIN_INTERVAL_MILLIS)
+        return false;
+
+    // Pull the line low to wake up the sensor
+    DHT_PORT &= ~DHT_BIT;
+    DHT_DDR |= DHT_BIT;
+
+    dhtState = DHT_START;
+    dhtStateTime = millis();
+    dhtLastStart = dhtStateTime;
+    dhtStarted = true;
+
+    return true;
+}
+
+void dhtUpdate()
+{
+    switch (dhtState)
+    {
+        case DHT_IDLE:
+            break;
+
+        case DHT_START:
+        {
+            if (millis() - dhtStateTime < DHT_START_MILLIS)
+                break;
+
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+            {
+                for (uint8_t i = 0; i < DHT_BYTES; i++)
+                    dhtData[i] = 0;
+
+                dhtEdges = 0;
+                dhtLastEdge = TCNT2;
+                dhtLastLevel = DHT_BIT;
+
+                // Release the line and let the sensor answer
+                DHT_DDR &= ~DHT_BIT;
+                DHT_PORT |= DHT_BIT;
+
+                PCIFR = _BV(PCIF2);
+                PCMSK2 |= DHT_PCINT_BIT;
+            }
+
+            dhtState = DHT_READING;
+            dhtStateTime = millis();
+        }
+        break;
+
+        case DHT_READING:
+        {
+            uint8_t edges;
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+            {
+                edges = dhtEdges;
+            }
+
+            if (edges >= DHT_FIRST_DATA_EDGE + DHT_BITS)
+            {
+                dhtStopCapture();
+                dhtState = DHT_IDLE;
+
+                DhtSample sample;
+                if (dhtDecode(sample))
+                {
+                    dhtLatest = sample;
+                    dhtLatestReady = true;
+                }
+                else
+                    dhtErrors++;
+            }
+            else if (millis() - dhtStateTime > DHT_TIMEOUT_MILLIS)
+            {
+                dhtStopCapture();
+                dhtState = DHT_IDLE;
+                dhtErrors++;
+            }
+        }
+        break;
+    }
+}
+
+bool dhtBusy()
+{
+    return dhtState != DHT_IDLE;
+}
+
+bool dhtReadSample(DhtSample& sample)
+{
+    if (!dhtLatestReady)
+        return false;
+
+    sample = dhtLatest;
+    dhtLatestReady = false;
+
+    return true;
+}
+
+bool dhtWaitForSample(DhtSample& sample, uint16_t timeoutMillis)
+{
+    unsigned long start = millis();
+
+    dhtStartReading();
+
+    while (millis() - start < timeoutMillis)
+    {
+        dhtUpdate();
+
+        if (dhtReadSample(sample))
+            return true;
+
+        if (!dhtBusy())
+            return false;
+    }
+
+    return false;
+}
+
+uint16_t dhtErrorCount()
+{
+    return dhtErrors;
+}
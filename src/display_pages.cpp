@@ -0,0 +1,41 @@
+#include "display_pages.h"
+
+#include "crc.h"
+
+// The SSD1306 is split into 8 pixel tall pages, one byte per column
+#define DISPLAY_MAX_PAGES 8
+
+static uint16_t pageChecksums[DISPLAY_MAX_PAGES];
+static uint8_t validPages = 0;
+
+static uint16_t pageChecksum(const uint8_t* page, uint8_t width)
+{
+    // A CRC rather than a running sum: 72 and 27 are the same glyph columns
+    // in another order, and sums that wrap at 256 can't tell them apart.
+    // A collision leaves the old page on the panel.
+    uint16_t crc = 0xFFFF;
+
+    for (uint8_t i = 0; i < width; i++)
+        crc = crc16Update(crc, page[i]);
+
+    return crc;
+}
+
+void displayInvalidatePages()
+{
+    validPages = 0;
+}
+
+bool displayPageChanged(uint8_t page, const uint8_t* data, uint8_t width)
+{
+    uint16_t checksum = pageChecksum(data, width);
+
+    // Skip pages the panel already shows
+    if ((validPages & (1 << page)) && pageChecksums[page] == checksum)
+        return false;
+
+    pageChecksums[page] = checksum;
+    validPages |= (1 << page);
+
+    return true;
+}
@@ -0,0 +1,102 @@
+#include "encoder.h"
+
+#include "spsc_queue.h"
+
+// Encoder A (CLK) is D3 / PD3 and B (DT) is D2 / PD2, on INT1 and INT0
+#define ENCODER_A_PIN 3
+#define ENCODER_B_PIN 2
+#define ENCODER_A_BIT _BV(3)
+#define ENCODER_B_BIT _BV(2)
+
+// Detents closer together than this in the same direction count as 10
+#define ENCODER_FAST_MICROS 25000
+#define ENCODER_FAST_STEPS 10
+
+#define ENCODER_QUEUE_SIZE 16
+
+static SpscQueue<EncoderEvent, ENCODER_QUEUE_SIZE> encoderEvents;
+static volatile uint8_t encoderDropped = 0;
+static void (*encoderDetent)() = nullptr;
+
+static void encoderPush(int8_t steps)
+{
+    EncoderEvent event;
+    event.steps = steps;
+    event.time = static_cast<uint16_t>(millis());
+
+    if (!encoderEvents.push(event))
+    {
+        if (encoderDropped < 0xFF)
+            encoderDropped++;
+    }
+
+    if (encoderDetent != nullptr)
+        encoderDetent();
+}
+
+void encoderBegin(void (*onDetent)())
+{
+    encoderDetent = onDetent;
+
+#ifdef __AVR__
+    attachInterrupt(digitalPinToInterrupt(ENCODER_A_PIN), encoderChanged, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(ENCODER_B_PIN), encoderChanged, CHANGE);
+#endif
+}
+
+void encoderChanged()
+{
+    // Updates the queue when the pins are valid and have rotated a full indent
+
+    static uint8_t old_AB = 3; // Lookup table index
+    static int8_t  encval = 0; // Encoder value
+    static const int8_t  enc_states[] = {0,-1,1,0,1,0,0,-1,-1,0,0,1,0,1,-1,0};
+    static unsigned long lastDetent = 0;
+    static int8_t lastDirection = 0;
+
+    old_AB <<= 2; // Remember previous state
+
+#ifdef __AVR__
+    // Both pins are on port D, read them together
+    uint8_t pins = PIND;
+    if (pins & ENCODER_A_BIT) old_AB |= 0x02; // Add current state of pin A
+    if (pins & ENCODER_B_BIT) old_AB |= 0x01; // Add current state of pin B
+#endif
+
+    encval += enc_states[(old_AB & 0x0F)];
+
+    // Queue a detent if encoder has rotated a full indent, this is at least 4 steps
+    if (encval > 3 || encval < -3)
+    {
+        int8_t direction = (encval > 0) ? 1 : -1;
+        unsigned long now = micros();
+
+        // Spinning quickly in one direction accelerates
+        int8_t steps = direction;
+        if (direction == lastDirection && (now - lastDetent) < ENCODER_FAST_MICROS)
+            steps = direction * ENCODER_FAST_STEPS;
+
+        lastDetent = now;
+        lastDirection = direction;
+        encval = 0;
+
+        encoderPush(steps);
+    }
+}
+
+bool encoderReadEvent(EncoderEvent& event)
+{
+    return encoderEvents.pop(event);
+}
+
+uint8_t encoderDroppedCount()
+{
+    return encoderDropped;
+}
+
+#ifndef __AVR__
+void encoderMockDetent(int8_t steps)
+{
+    encoderPush(steps);
+}
+#endif
@@ -0,0 +1,217 @@
+#include "fan_output.h"
+
+// The shift register backend is in fan_shift_output.cpp
+#ifndef FAN_SHIFT_REGISTER
+
+#ifdef __AVR__
+#include <util/atomic.h>
+#endif
+
+// Fan 1 is D6 (PD6), fan 2 D5 (PD5), fan 3 D10 (PB2) and fan 4 D9 (PB1)
+#define FAN1_PORTD_BIT _BV(6)
+#define FAN2_PORTD_BIT _BV(5)
+#define FAN3_PORTB_BIT _BV(2)
+#define FAN4_PORTB_BIT _BV(1)
+
+#define FAN_PORTD_MASK (FAN1_PORTD_BIT | FAN2_PORTD_BIT)
+#define FAN_PORTB_MASK (FAN3_PORTB_BIT | FAN4_PORTB_BIT)
+
+static_assert(FAN_COUNT == 4, "Only four fans have PWM pins");
+
+static uint8_t fanDuty[FAN_COUNT];
+static uint8_t fanMask = 0;
+static uint8_t fanPwmMask = 0;
+static uint8_t fanPortB = 0;
+static uint8_t fanPortD = 0;
+static uint16_t fanWrites = 0;
+
+#ifndef __AVR__
+static uint8_t mockPortB = 0;
+static uint8_t mockPortD = 0;
+#endif
+
+static void fanPortBits(uint8_t mask, uint8_t& portB, uint8_t& portD)
+{
+    portD = 0;
+    portB = 0;
+
+    if (mask & 0x01)
+        portD |= FAN1_PORTD_BIT;
+    if (mask & 0x02)
+        portD |= FAN2_PORTD_BIT;
+    if (mask & 0x04)
+        portB |= FAN3_PORTB_BIT;
+    if (mask & 0x08)
+        portB |= FAN4_PORTB_BIT;
+}
+
+static void fanWritePortB(uint8_t bits)
+{
+#ifdef __AVR__
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        PORTB = (PORTB & ~FAN_PORTB_MASK) | bits;
+    }
+#else
+    mockPortB = (mockPortB & ~FAN_PORTB_MASK) | bits;
+#endif
+
+    fanWrites++;
+}
+
+static void fanWritePortD(uint8_t bits)
+{
+#ifdef __AVR__
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        PORTD = (PORTD & ~FAN_PORTD_MASK) | bits;
+    }
+#else
+    mockPortD = (mockPortD & ~FAN_PORTD_MASK) | bits;
+#endif
+
+    fanWrites++;
+}
+
+static void fanWriteCompare(uint8_t fan, uint8_t duty, bool connect)
+{
+#ifdef __AVR__
+    // Non-inverting PWM in the modes Arduino's init() already set up:
+    // fast PWM at 976Hz on Timer0, phase correct at 490Hz on Timer1.
+    switch (fan)
+    {
+        case 0:
+            OCR0A = duty;
+            TCCR0A = connect ? (TCCR0A | _BV(COM0A1)) : (TCCR0A & ~_BV(COM0A1));
+            break;
+        case 1:
+            OCR0B = duty;
+            TCCR0A = connect ? (TCCR0A | _BV(COM0B1)) : (TCCR0A & ~_BV(COM0B1));
+            break;
+        case 2:
+            OCR1B = duty;
+            TCCR1A = connect ? (TCCR1A | _BV(COM1B1)) : (TCCR1A & ~_BV(COM1B1));
+            break;
+        case 3:
+            OCR1A = duty;
+            TCCR1A = connect ? (TCCR1A | _BV(COM1A1)) : (TCCR1A & ~_BV(COM1A1));
+            break;
+    }
+#else
+    (void)fan;
+    (void)duty;
+    (void)connect;
+#endif
+
+    fanWrites++;
+}
+
+void fanOutputBegin()
+{
+#ifdef __AVR__
+    // Disconnect the PWM compare outputs so the port bits drive the pins,
+    // digitalWrite() used to do this on every call.
+    TCCR0A &= ~(_BV(COM0A1) | _BV(COM0B1));   // D6 OC0A, D5 OC0B
+    TCCR1A &= ~(_BV(COM1A1) | _BV(COM1B1));   // D9 OC1A, D10 OC1B
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        PORTD &= ~FAN_PORTD_MASK;
+        PORTB &= ~FAN_PORTB_MASK;
+        DDRD |= FAN_PORTD_MASK;
+        DDRB |= FAN_PORTB_MASK;
+    }
+#else
+    mockPortB = 0;
+    mockPortD = 0;
+#endif
+
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+        fanDuty[fan] = 0;
+
+    fanMask = 0;
+    fanPwmMask = 0;
+    fanPortB = 0;
+    fanPortD = 0;
+    fanWrites = 0;
+}
+
+void fanOutputApply(const uint8_t duty[FAN_COUNT])
+{
+    uint8_t fullMask = 0;
+    uint8_t pwmMask = 0;
+
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+    {
+        if (duty[fan] == FAN_DUTY_MAX)
+            fullMask |= 1 << fan;
+        else if (duty[fan] > 0)
+            pwmMask |= 1 << fan;
+    }
+
+    // Hand fans over to the timer first and back to the port last, so a
+    // pin never drops out between the two.
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+    {
+        if ((pwmMask & (1 << fan)) && duty[fan] != fanDuty[fan])
+            fanWriteCompare(fan, duty[fan], true);
+    }
+
+    uint8_t portB;
+    uint8_t portD;
+    fanPortBits(fullMask, portB, portD);
+
+    // Only touch the port whose fans changed
+    if (portB != fanPortB)
+        fanWritePortB(portB);
+
+    if (portD != fanPortD)
+        fanWritePortD(portD);
+
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+    {
+        if ((fanPwmMask & ~pwmMask) & (1 << fan))
+            fanWriteCompare(fan, 0, false);
+
+        fanDuty[fan] = duty[fan];
+    }
+
+    fanMask = fullMask | pwmMask;
+    fanPwmMask = pwmMask;
+    fanPortB = portB;
+    fanPortD = portD;
+}
+
+uint8_t fanOutputDuty(uint8_t fan)
+{
+    return (fan < FAN_COUNT) ? fanDuty[fan] : 0;
+}
+
+uint16_t fanOutputMask()
+{
+    return fanMask;
+}
+
+bool fanOutputPwmActive()
+{
+    return fanPwmMask != 0;
+}
+
+uint16_t fanOutputWriteCount()
+{
+    return fanWrites;
+}
+
+#ifndef __AVR__
+uint8_t fanMockPortB()
+{
+    return mockPortB;
+}
+
+uint8_t fanMockPortD()
+{
+    return mockPortD;
+}
+#endif
+
+#endif
@@ -0,0 +1,123 @@
+#include "fan_output.h"
+
+// The direct pin backend is in fan_output.cpp
+#ifdef FAN_SHIFT_REGISTER
+
+#ifdef __AVR__
+#include <util/atomic.h>
+#endif
+
+// A chain of 74HC595s on the hardware SPI pins: data from MOSI (D11),
+// clock from SCK (D13) and the latch on D10, which is also SS and has to
+// be an output for SPI master mode anyway. The chain's /OE is on D8 with
+// a pull-up, so the relays stay off until the registers have been cleared.
+#define FAN_LATCH_BIT _BV(2)    // D10, PB2
+#define FAN_MOSI_BIT _BV(3)     // D11, PB3
+#define FAN_SCK_BIT _BV(5)      // D13, PB5
+#define FAN_ENABLE_BIT _BV(0)   // D8, PB0, active low
+
+#define FAN_SHIFT_BYTES ((FAN_COUNT + 7) / 8)
+
+static uint8_t fanDuty[FAN_COUNT];
+static uint16_t fanMask = 0;
+static uint16_t fanWrites = 0;
+
+static void fanShiftOut(uint16_t mask)
+{
+#ifdef __AVR__
+    // The first byte ends up in the last register, so send the top fans
+    // first. MSB first puts fan 8n+1 on each register's QA.
+    for (int8_t i = FAN_SHIFT_BYTES - 1; i >= 0; i--)
+    {
+        SPDR = static_cast<uint8_t>(mask >> (i * 8));
+        while (!(SPSR & _BV(SPIF)))
+            ;
+    }
+
+    // Copy the shifted bits to the outputs all at once
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        PORTB |= FAN_LATCH_BIT;
+        PORTB &= ~FAN_LATCH_BIT;
+    }
+#else
+    (void)mask;
+#endif
+
+    fanWrites++;
+}
+
+void fanOutputBegin()
+{
+#ifdef __AVR__
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        PORTB &= ~(FAN_LATCH_BIT | FAN_MOSI_BIT | FAN_SCK_BIT);
+        PORTB |= FAN_ENABLE_BIT;
+        DDRB |= FAN_LATCH_BIT | FAN_MOSI_BIT | FAN_SCK_BIT | FAN_ENABLE_BIT;
+    }
+
+    // Master, mode 0, MSB first at 8MHz. The whole chain takes a few us.
+    SPCR = _BV(SPE) | _BV(MSTR);
+    SPSR = _BV(SPI2X);
+#endif
+
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+        fanDuty[fan] = 0;
+
+    fanMask = 0;
+    fanWrites = 0;
+
+    fanShiftOut(0);
+
+#ifdef __AVR__
+    // Every relay is known to be off now, let the outputs drive
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        PORTB &= ~FAN_ENABLE_BIT;
+    }
+#endif
+}
+
+void fanOutputApply(const uint8_t duty[FAN_COUNT])
+{
+    uint16_t mask = 0;
+
+    // A relay has no speeds, any duty switches it on. The duty is kept as
+    // asked for, so the next pass asking for the same sees no change.
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+    {
+        if (duty[fan] > 0)
+            mask |= 1U << fan;
+
+        fanDuty[fan] = duty[fan];
+    }
+
+    if (mask == fanMask)
+        return;
+
+    fanShiftOut(mask);
+    fanMask = mask;
+}
+
+uint8_t fanOutputDuty(uint8_t fan)
+{
+    return (fan < FAN_COUNT) ? fanDuty[fan] : 0;
+}
+
+uint16_t fanOutputMask()
+{
+    return fanMask;
+}
+
+bool fanOutputPwmActive()
+{
+    return false;
+}
+
+uint16_t fanOutputWriteCount()
+{
+    return fanWrites;
+}
+
+#endif
@@ -0,0 +1,380 @@
+#include "history.h"
+
+#ifdef HISTORY_EEPROM
+#include <EEPROM.h>
+
+#ifdef __AVR__
+#include <avr/eeprom.h>
+#endif
+
+#include "crc.h"
+#endif
+
+static_assert(HISTORY_BLOCKS >= 2, "Dropping a block has to leave one");
+static_assert(HISTORY_SAMPLES <= 255, "Positions are bytes");
+
+// Steps from the sample before, the first step of each block is unused
+// since blockFirst holds that sample exactly.
+static int8_t steps[HISTORY_SERIES][HISTORY_SAMPLES];
+static int16_t blockFirst[HISTORY_SERIES][HISTORY_BLOCKS];
+static int16_t blockMinimum[HISTORY_SERIES][HISTORY_BLOCKS];
+static int16_t blockMaximum[HISTORY_SERIES][HISTORY_BLOCKS];
+
+static int16_t latest[HISTORY_SERIES];
+static int16_t windowMinimum[HISTORY_SERIES];
+static int16_t windowMaximum[HISTORY_SERIES];
+static int32_t windowSum[HISTORY_SERIES];
+
+static uint8_t oldestBlock = 0;
+static uint8_t sampleCount = 0;
+static uint16_t revision = 0;
+
+#ifdef HISTORY_EEPROM
+// Archived blocks go round-robin over the upper half of the EEPROM, the
+// lower half is the settings store's.
+#define ARCHIVE_START 512
+#define ARCHIVE_BYTES 512
+
+// Record layout: marker, sequence (2 bytes), the block, CRC-8 of the rest
+#define ARCHIVE_MARKER 0xB1
+#define RECORD_MARKER 0
+#define RECORD_SEQUENCE 1
+#define RECORD_PAYLOAD 3
+#define RECORD_SERIES_SIZE (2 + HISTORY_BLOCK_SAMPLES - 1)
+#define RECORD_CRC (RECORD_PAYLOAD + HISTORY_SERIES * RECORD_SERIES_SIZE)
+#define RECORD_SIZE (RECORD_CRC + 1)
+
+#define ARCHIVE_SLOTS (ARCHIVE_BYTES / RECORD_SIZE)
+
+static uint8_t archiveNewestSlot = ARCHIVE_SLOTS - 1;
+static uint16_t archiveSequence = 0;
+static uint8_t archiveCount = 0;
+
+// The record being written, byte by byte
+static uint8_t pendingRecord[RECORD_SIZE];
+static uint8_t pendingSlot = 0;
+static int8_t pendingStep = -1;
+
+static int slotAddress(uint8_t slot)
+{
+    return ARCHIVE_START + slot * RECORD_SIZE;
+}
+
+static bool readRecord(uint8_t slot, uint8_t record[RECORD_SIZE])
+{
+    int address = slotAddress(slot);
+    uint8_t crc = 0;
+
+    for (uint8_t i = 0; i < RECORD_SIZE; i++)
+    {
+        record[i] = EEPROM.read(address + i);
+
+        if (i < RECORD_CRC)
+            crc = crc8Update(crc, record[i]);
+    }
+
+    return record[RECORD_MARKER] == ARCHIVE_MARKER && record[RECORD_CRC] == crc;
+}
+
+static uint16_t recordSequence(const uint8_t record[RECORD_SIZE])
+{
+    return record[RECORD_SEQUENCE] | (static_cast<uint16_t>(record[RECORD_SEQUENCE + 1]) << 8);
+}
+
+static bool eepromReady()
+{
+#ifdef __AVR__
+    return eeprom_is_ready();
+#else
+    return true;
+#endif
+}
+
+static void archiveBlock(uint8_t block)
+{
+    // One block every HISTORY_BLOCK_SAMPLES intervals, the last one has
+    // long finished. If not, it's restarted with this one.
+    if (pendingStep < 0)
+        pendingSlot = (archiveNewestSlot + 1 >= ARCHIVE_SLOTS) ? 0 : archiveNewestSlot + 1;
+
+    archiveSequence++;
+
+    pendingRecord[RECORD_MARKER] = ARCHIVE_MARKER;
+    pendingRecord[RECORD_SEQUENCE] = static_cast<uint8_t>(archiveSequence);
+    pendingRecord[RECORD_SEQUENCE + 1] = static_cast<uint8_t>(archiveSequence >> 8);
+
+    uint8_t* payload = pendingRecord + RECORD_PAYLOAD;
+
+    for (uint8_t series = 0; series < HISTORY_SERIES; series++)
+    {
+        *payload++ = lowByte(blockFirst[series][block]);
+        *payload++ = highByte(blockFirst[series][block]);
+        memcpy(payload, &steps[series][block * HISTORY_BLOCK_SAMPLES + 1], HISTORY_BLOCK_SAMPLES - 1);
+        payload += HISTORY_BLOCK_SAMPLES - 1;
+    }
+
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < RECORD_CRC; i++)
+        crc = crc8Update(crc, pendingRecord[i]);
+    pendingRecord[RECORD_CRC] = crc;
+
+    pendingStep = 0;
+}
+#endif
+
+static void dropOldestBlock()
+{
+#ifdef HISTORY_EEPROM
+    archiveBlock(oldestBlock);
+#endif
+
+    uint8_t start = oldestBlock * HISTORY_BLOCK_SAMPLES;
+
+    // Take the block's samples back out of the sums
+    for (uint8_t series = 0; series < HISTORY_SERIES; series++)
+    {
+        int16_t value = blockFirst[series][oldestBlock];
+        windowSum[series] -= value;
+
+        for (uint8_t i = 1; i < HISTORY_BLOCK_SAMPLES; i++)
+        {
+            value += steps[series][start + i];
+            windowSum[series] -= value;
+        }
+    }
+
+    oldestBlock = (oldestBlock + 1) % HISTORY_BLOCKS;
+    sampleCount -= HISTORY_BLOCK_SAMPLES;
+
+    // The extremes come from the summaries of the blocks that are left
+    for (uint8_t series = 0; series < HISTORY_SERIES; series++)
+    {
+        windowMinimum[series] = blockMinimum[series][oldestBlock];
+        windowMaximum[series] = blockMaximum[series][oldestBlock];
+
+        for (uint8_t i = 1; i < sampleCount / HISTORY_BLOCK_SAMPLES; i++)
+        {
+            uint8_t block = (oldestBlock + i) % HISTORY_BLOCKS;
+
+            windowMinimum[series] = min(windowMinimum[series], blockMinimum[series][block]);
+            windowMaximum[series] = max(windowMaximum[series], blockMaximum[series][block]);
+        }
+    }
+}
+
+void historyBegin()
+{
+#ifdef HISTORY_EEPROM
+    uint8_t record[RECORD_SIZE];
+    bool found = false;
+
+    archiveCount = 0;
+
+    for (uint8_t slot = 0; slot < ARCHIVE_SLOTS; slot++)
+    {
+        if (!readRecord(slot, record))
+            continue;
+
+        uint16_t sequence = recordSequence(record);
+
+        // Sequence numbers wrap, newer means ahead by less than half the range
+        if (!found || static_cast<int16_t>(sequence - archiveSequence) > 0)
+        {
+            archiveNewestSlot = slot;
+            archiveSequence = sequence;
+            found = true;
+        }
+    }
+
+    if (!found)
+        return;
+
+    // Only the run of records going back from the newest one counts. A torn
+    // or missing record, or one newer than the record after it, ends the
+    // run and anything before it is left out.
+    uint8_t slot = archiveNewestSlot;
+    uint16_t newer = archiveSequence + 1;
+
+    while (archiveCount < ARCHIVE_SLOTS && readRecord(slot, record) &&
+           static_cast<int16_t>(newer - recordSequence(record)) > 0)
+    {
+        newer = recordSequence(record);
+        archiveCount++;
+        slot = (slot == 0) ? ARCHIVE_SLOTS - 1 : slot - 1;
+    }
+#endif
+}
+
+void historyAdd(const int16_t values[HISTORY_SERIES])
+{
+    if (sampleCount == HISTORY_SAMPLES)
+        dropOldestBlock();
+
+    uint8_t position = (oldestBlock * HISTORY_BLOCK_SAMPLES + sampleCount) % HISTORY_SAMPLES;
+    uint8_t block = position / HISTORY_BLOCK_SAMPLES;
+    bool blockStart = (position % HISTORY_BLOCK_SAMPLES) == 0;
+
+    for (uint8_t series = 0; series < HISTORY_SERIES; series++)
+    {
+        int16_t value = values[series];
+
+        if (blockStart)
+        {
+            blockFirst[series][block] = value;
+            blockMinimum[series][block] = value;
+            blockMaximum[series][block] = value;
+        }
+        else
+        {
+            // Store what a byte can hold, the rest shows up in later steps
+            int16_t step = constrain(value - latest[series], -128, 127);
+            steps[series][position] = static_cast<int8_t>(step);
+            value = latest[series] + step;
+
+            blockMinimum[series][block] = min(blockMinimum[series][block], value);
+            blockMaximum[series][block] = max(blockMaximum[series][block], value);
+        }
+
+        if (sampleCount == 0)
+        {
+            windowMinimum[series] = value;
+            windowMaximum[series] = value;
+        }
+        else
+        {
+            windowMinimum[series] = min(windowMinimum[series], value);
+            windowMaximum[series] = max(windowMaximum[series], value);
+        }
+
+        windowSum[series] += value;
+        latest[series] = value;
+    }
+
+    sampleCount++;
+    revision++;
+}
+
+uint8_t historyCount()
+{
+    return sampleCount;
+}
+
+uint16_t historyRevision()
+{
+    return revision;
+}
+
+int16_t historyLatest(uint8_t series)
+{
+    return latest[series];
+}
+
+int16_t historyMinimum(uint8_t series)
+{
+    return windowMinimum[series];
+}
+
+int16_t historyMaximum(uint8_t series)
+{
+    return windowMaximum[series];
+}
+
+int16_t historyMean(uint8_t series)
+{
+    if (sampleCount == 0)
+        return 0;
+
+    return static_cast<int16_t>(windowSum[series] / sampleCount);
+}
+
+HistoryReader::HistoryReader(uint8_t series) :
+    series(series), position(oldestBlock * HISTORY_BLOCK_SAMPLES), remaining(sampleCount), value(0)
+{
+}
+
+bool HistoryReader::next(int16_t& next)
+{
+    if (remaining == 0)
+        return false;
+
+    if (position % HISTORY_BLOCK_SAMPLES == 0)
+        value = blockFirst[series][position / HISTORY_BLOCK_SAMPLES];
+    else
+        value += steps[series][position];
+
+    position = (position + 1) % HISTORY_SAMPLES;
+    remaining--;
+
+    next = value;
+    return true;
+}
+
+#ifdef HISTORY_EEPROM
+bool historyUpdate()
+{
+    if (pendingStep < 0)
+        return false;
+
+    // Let the previous byte finish rather than wait for it
+    if (!eepromReady())
+        return true;
+
+    int address = slotAddress(pendingSlot);
+
+    // Clear the marker first and set it last, as the settings store does
+    if (pendingStep == 0)
+    {
+        // With every slot in use this one held the oldest block
+        if (archiveCount == ARCHIVE_SLOTS)
+            archiveCount--;
+
+        EEPROM.update(address + RECORD_MARKER, 0);
+    }
+    else if (pendingStep < RECORD_SIZE)
+        EEPROM.update(address + pendingStep, pendingRecord[pendingStep]);
+    else
+        EEPROM.update(address + RECORD_MARKER, ARCHIVE_MARKER);
+
+    if (++pendingStep <= RECORD_SIZE)
+        return true;
+
+    // The run of records from the newest one is a block longer
+    archiveCount++;
+
+    archiveNewestSlot = pendingSlot;
+    pendingStep = -1;
+
+    return false;
+}
+
+uint8_t historyArchiveCount()
+{
+    return archiveCount;
+}
+
+bool historyArchiveRead(uint8_t index, HistoryBlock& block)
+{
+    if (index >= archiveCount)
+        return false;
+
+    // The records counted run back from the newest one without a gap
+    uint8_t slot = (archiveNewestSlot + ARCHIVE_SLOTS + 1 - archiveCount + index) % ARCHIVE_SLOTS;
+    uint8_t record[RECORD_SIZE];
+
+    if (!readRecord(slot, record))
+        return false;
+
+    block.sequence = recordSequence(record);
+
+    const uint8_t* payload = record + RECORD_PAYLOAD;
+
+    for (uint8_t series = 0; series < HISTORY_SERIES; series++)
+    {
+        block.first[series] = static_cast<int16_t>(payload[0] | (payload[1] << 8));
+        memcpy(block.steps[series], payload + 2, HISTORY_BLOCK_SAMPLES - 1);
+        payload += RECORD_SERIES_SIZE;
+    }
+
+    return true;
+}
+#endif
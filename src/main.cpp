@@ -1,49 +1,126 @@
 #include <Arduino.h>
-#include <Wire.h>
-#include <Adafruit_SSD1306.h>
-#include <DHT.h>
 #include <EEPROM.h>
-#include <LowPower.h>
+
+#include "dht11.h"
+#include "big_text.h"
+#include "button.h"
+#include "encoder.h"
+#include "fixed_point.h"
+#include "history.h"
+#include "page_display.h"
+#include "fan_output.h"
+#include "pi_controller.h"
+#include "power.h"
+#include "profiler.h"
+#include "ring_filter.h"
+#include "scheduler.h"
+#include "settings_store.h"
+#include "solar_adc.h"
+#include "telemetry.h"
+#include "trace.h"
 
 // P I N O U T S
 
-// ENCODER
+// ENCODER, the rotation pins are read directly by encoder.cpp and the push
+// button by button.cpp
 #define ENC_DT_PIN 2
 #define ENC_CLK_PIN 3
 #define ENC_SW_PIN 4
 
 // TEMP/HUMIDITY
-#define DHT_PIN 7
-#define DHT_DELAY 500000
+#define DHT_PIN 7           // Driven directly by dht11.cpp
+#define DHT_DELAY 2000      // Milliseconds between readings
+#define DHT_POLL_DELAY 2    // Milliseconds between checks while a reading is captured
+#define DHT_RETRY_DELAY 100
+#define DHT_BOOT_TIMEOUT 100
 
 // LIGHT SENSOR
-#define SOLAR_PIN A0
-#define SOLAR_DELAY 500000
-
-// FANS 5, 6, 9, 10
-#define FAN1_PIN 6
-#define FAN2_PIN 5
-#define FAN3_PIN 10
-#define FAN4_PIN 9
+#define SOLAR_PIN A0        // Sampled by solar_adc.cpp
+#define SOLAR_DELAY 500     // Milliseconds between readings
+#define SOLAR_POLL_DELAY 4  // Milliseconds between checks while a block is sampled
+
+// FANS, FAN_COUNT of them driven by fan_output.cpp: on pins 6, 5, 10 and
+// 9, or on a 74HC595 chain when built with -DFAN_SHIFT_REGISTER
+
+// TASKS, periods in milliseconds. Input, display and fans also run as soon
+// as something they depend on changes.
+#define INPUT_DELAY 100
+#define DISPLAY_DELAY 1000
+#define DISPLAY_POLL_DELAY 2    // A page takes about 3ms to send at 400kHz
+#define FAN_DELAY 1000
+#define FAN_RAMP_DELAY 100  // Milliseconds between soft-start steps
+#define FAN_RAMP_STEP 16    // Duty added each step, minimum to full in 1.2s
+#define FAN_MIN_DUTY 64     // Slower than this and the fans stall
+#define FAN_STAGGER_MILLIS 500  // Between stopped fans starting, so their inrush doesn't add up
+
+// FAN_AUTO switching. A stopped fan starts once the loops ask for
+// FAN_START_DUTY and a running one stops once they ask for less than
+// FAN_STOP_DUTY, in between it holds at FAN_MIN_DUTY or more. After
+// switching it stays put for its minimum on or off time. Any of them can
+// be set from the build flags.
+#ifndef FAN_START_DUTY
+#define FAN_START_DUTY 96
+#endif
+#ifndef FAN_STOP_DUTY
+#define FAN_STOP_DUTY 32
+#endif
+#ifndef FAN_MIN_ON_MILLIS
+#define FAN_MIN_ON_MILLIS 120000UL
+#endif
+#ifndef FAN_MIN_OFF_MILLIS
+#define FAN_MIN_OFF_MILLIS 60000UL
+#endif
+
+// FAN_AUTO PI gains, Q8 (see pi_controller.h). Temperature error is in
+// tenths of a degree F: full speed about 4F over, plus the integral
+// building up 0.1 duty a second for each tenth. Humidity error is in
+// percent: full speed 10% over. Any of them can be set from the build
+// flags, to try other gains in the simulator.
+#ifndef FAN_TEMPERATURE_KP
+#define FAN_TEMPERATURE_KP 1536
+#endif
+#ifndef FAN_TEMPERATURE_KI
+#define FAN_TEMPERATURE_KI 24
+#endif
+#ifndef FAN_HUMIDITY_KP
+#define FAN_HUMIDITY_KP 6528
+#endif
+#ifndef FAN_HUMIDITY_KI
+#define FAN_HUMIDITY_KI 218
+#endif
+
+// FAN_AUTO looks this far ahead along the temperature and humidity trends,
+// so the fans are already turning when a rising reading gets to its
+// setpoint. 0 turns it off, it can be set from the build flags too.
+#ifndef FAN_PREDICT_SECONDS
+#define FAN_PREDICT_SECONDS 600
+#endif
+#define FAN_PREDICT_SAMPLES (FAN_PREDICT_SECONDS * 1000UL / TREND_INTERVAL_MILLIS)
+#define SERIAL_DELAY 100
+#define SETTINGS_DELAY 1000
+#define SETTINGS_POLL_DELAY 4   // An EEPROM byte write takes 3.3ms
+#define TELEMETRY_DELAY 1000
+#define HISTORY_DELAY 10000     // Checks for a due sample, see HISTORY_INTERVAL_MILLIS
+#define HISTORY_POLL_DELAY 4    // Archiving to EEPROM, with -DHISTORY_EEPROM
+
+// SERIAL, binary telemetry frames out and single character commands in
+#define SERIAL_BAUD 115200
 
 // DISPLAY
 #define SCREEN_WIDTH 128 // OLED display width, in pixels
 #define SCREEN_HEIGHT 64 // OLED display height, in pixels
 #define SCREEN_TOP 16       // Top yellow area
 #define SCREEN_BOTTOM 48    // Bottom blue area
-
-// Display Screens
-#define SCRN_TEMP 0
-#define SCRN_HUMIDITY 1
-#define SCRN_SOLAR 2
-#define SCRN_FAN1 3
-#define SCRN_FAN2 4
-#define SCRN_FAN3 5
-#define SCRN_FAN4 6
-#define SCRN_POWER 7
+#define SCREEN_ADDRESS 0x3C // I2C address of the SSD1306
+#define SCREEN_VALUE_PAGE 4 // Big text fills pages 4-6, rows 32 to 55
+#define SPARKLINE_X 4       // One column per history sample
+#define SPARKLINE_TOP 19
+#define SPARKLINE_HEIGHT 42
+#define SPARKLINE_LABEL_X 102   // Maximum, mean and minimum beside the line
+
+// Display Screens, laid out by screenTable
+#define SCRN_FIRST 0
 #define SCRN_CLICKS 1
-#define SCRN_FIRST SCRN_TEMP
-#define SCRN_LAST SCRN_POWER
 
 
 // FAN OPTIONS
@@ -58,144 +135,258 @@
 
 #define MAX_SAMPLES 32
 
-#define GUID 27381
-#define GUID_ADDR 0
-#define TEMPERATURE_ADDR 10
-#define HUMIDITY_ADDR 11
-#define SOLAR_ADDR 12
-#define FAN_1_ADDR 13
-#define FAN_2_ADDR 14
-#define FAN_3_ADDR 15
-#define FAN_4_ADDR 16
-#define POWER_ADDR 17
+// Least-squares trends take a raw reading this often, a 16 minute window
+#define TREND_SAMPLES 32
+#define TREND_INTERVAL_MILLIS 30000UL
+
+// Where settings lived before the settings store, read once to migrate
+#define LEGACY_GUID 27381
+#define LEGACY_GUID_ADDR 0
+#define LEGACY_TEMPERATURE_ADDR 10
+#define LEGACY_HUMIDITY_ADDR 11
+#define LEGACY_SOLAR_ADDR 12
+#define LEGACY_FAN_1_ADDR 13
+#define LEGACY_FAN_COUNT 4
+#define LEGACY_POWER_ADDR 17
+
+// One entry per fan: the fan_output channel that drives it and its place
+// in Settings::fans. Fan n is edited on the nth screen of the fan row.
+struct FanChannel
+{
+    uint8_t output;
+    uint8_t settingsSlot;
+    int option;
+    unsigned long switchedMillis;   // When the output last started or stopped
+    uint16_t switches;              // Starts and stops since the last report
+};
 
-// G L O B A L S
+// How a screen draws and edits its setting
+enum ScreenKind : uint8_t
+{
+    SCREEN_VALUES,  // Reading and set point side by side, edited in steps
+    SCREEN_FAN,     // Fan option and live duty, the options wrap around
+    SCREEN_POWER,   // Power option, the options wrap around
+    SCREEN_HISTORY  // Sparkline of one history series, nothing to edit
+};
 
-DHT dht(DHT_PIN, DHT11);
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+// One row per screen, or per run of count screens that differ only by the
+// index passed to the getters (one per fan). The table is in PROGMEM.
+struct ScreenDescriptor
+{
+    const char* title;                  // PROGMEM
+    ScreenKind kind;
+    uint8_t count;
+    int (*current)(uint8_t index);      // Shown beside the setting
+    int (*setting)(uint8_t index);
+    void (*edit)(uint8_t index, int value);     // Or nullptr, not editable
+    int8_t minimum;
+    int8_t maximum;
+};
 
-int buttonState;            // the current reading from the input pin
-int lastButtonState = LOW;  //
-unsigned long lastDebounceTime = 0;  // the last time the output pin was toggled
-constexpr unsigned long debounceDelay = 50;
+// Snapshot of everything the current screen shows. The display is only
+// rebuilt and flushed when this changes.
+struct ViewModel
+{
+    int screen;
+    bool editMode;
+    int currentValue;
+    int setValue;   // Or the option
+
+    bool operator==(const ViewModel& other) const
+    {
+        return screen == other.screen && editMode == other.editMode &&
+               currentValue == other.currentValue && setValue == other.setValue;
+    }
 
-enum encoderDirectionType
+    bool operator!=(const ViewModel& other) const { return !(*this == other); }
+};
+
+// The history screen's sparkline, copied out when its view starts drawing
+// so every page shows the same window even if a sample lands mid-draw.
+// The view itself only holds historyRevision().
+struct HistoryView
 {
-    CW,
-    CCW
+    uint8_t count;
+    int16_t minimum;
+    int16_t maximum;
+    int16_t mean;
+    uint8_t rows[HISTORY_SAMPLES];  // Sparkline row of each sample, oldest first
 };
 
-volatile int encCnt = 0;
-int encCntLast = 0;
-encoderDirectionType encDir = CW;
-unsigned long encLastIncTime = micros();
-unsigned long encLastDecTime = micros();
-unsigned long encPauseLength = 25000;
+// G L O B A L S
+
+PageDisplay display(SCREEN_WIDTH, SCREEN_HEIGHT);
+bool displayFound = false;      // The panel answered at boot
 
 int setHumidity;
 int setTemperature;
-float currentHumidity;
-float currentTemperature;
+int16_t currentTemperatureTenths;  // Fahrenheit, averaged
 int currentTemperatureInt;
 int currentHumidityInt;
 int lastHumidity;
-int lastTemperature;
-int temperatureSamples[MAX_SAMPLES];
-int temperatureIndex;
-
+int lastTemperature;                // Celsius tenths of the last reading
+RingFilter<int16_t, MAX_SAMPLES, int32_t> temperatureSamples;
+TrendFilter<int16_t, TREND_SAMPLES> temperatureTrend;  // Fahrenheit tenths
+TrendFilter<int16_t, TREND_SAMPLES> humidityTrend;
+unsigned long lastTrendMillis = 0;
+bool dhtSeeded = false;             // The averages and trends hold a real reading
 
 int setSolar;
 int currentSolar;
 int lastSolar;
-int solarSamples[MAX_SAMPLES];
-int solarIndex;
+RingFilter<uint8_t, MAX_SAMPLES> solarSamples;
 
-int fan1Option;
-int fan2Option;
-int fan3Option;
-int fan4Option;
+FanChannel fans[FAN_COUNT];
 
 int powerOption;
 
+PiController temperatureControl(FAN_TEMPERATURE_KP, FAN_TEMPERATURE_KI);
+PiController humidityControl(FAN_HUMIDITY_KP, FAN_HUMIDITY_KI);
+unsigned long lastFanMillis = 0;
+unsigned long lastRampMillis = 0;
+unsigned long lastStartMillis = 0;
+unsigned long switchStatsMillis = 0;
+
+unsigned long lastHistoryMillis = 0;
+
 bool editMode;
+Settings editStart;     // Restored when an edit is cancelled
 
 int currentScreen;
 
-void beginDisplay();
+ViewModel shownView;
+bool shownViewValid = false;
+ViewModel drawingView;
+HistoryView drawingHistory;     // For drawingView, when it's a history screen
+uint8_t drawingPage = SCREEN_HEIGHT / 8;    // Past the last page when idle
+
+uint8_t inputTask;
+uint8_t dhtTask;
+uint8_t solarTask;
+uint8_t displayTask;
+uint8_t fanTask;
+uint8_t serialTask;
+uint8_t settingsTask;
+uint8_t telemetryTask;
+uint8_t historyTask;
+
+void knobTurned();
+void buttonPressed();
+void inputChanged();
+void updateInput();
+void updateAllFans();
+void printTaskStats();
+void printFanSwitches();
+void resetFanSwitches();
+#ifdef PROFILE_STAGES
+void printProfile();
+#endif
+ViewModel buildViewModel();
+void updateDisplay();
+void renderView(const ViewModel& view);
+void beginDisplay(bool edit);
 int getTextWidth(const char* text);
 int getTextHeight(const char* text);
-int updateEditMode();
+void updateEditMode();
 void updateEncoder();
+void seedDhtReadings(const DhtSample& sample);
 void updateDHT();
 void displayTitle(const char* title);
-void displayFanTitle(int fan);
-void displayValues(int lastValue, int currentValue, int setValue);
-void displayFanOption(int option);
-void updateFans(int fan, int option);
-int updateFanOptionForward(int option);
-int updateFanOptionBackward(int option);
-int updatePowerOptionForward(int option);
-int updatePowerOptionBackward(int option);
+void displayFanTitle(const char* title, uint8_t fan);
+void beginFanChannels();
+ScreenDescriptor screenAt(int screen, uint8_t& index);
+bool screenEditable(int screen);
+void editScreen(int screen, int steps);
+void displayValues(int currentValue, int setValue);
+void displayFanOption(int option, int dutyPercent);
+bool fansPowered();
+uint8_t autoFanDuty(uint16_t elapsedMillis);
+uint8_t fanTargetDuty(const FanChannel& channel, uint8_t autoDuty, unsigned long now);
+uint8_t autoSwitchDuty(const FanChannel& channel, uint8_t autoDuty, unsigned long now);
+uint8_t rampFanDuty(uint8_t current, uint8_t target, bool stepDue);
+int dutyToPercent(uint8_t duty);
 void displayPowerOption(int option);
+void snapshotHistory(uint8_t series, HistoryView& history);
+void displayHistory(uint8_t series, const HistoryView& history);
+void printHistoryValue(uint8_t series, int16_t value);
+void addHistorySample();
+void updateHistory();
+void printHistory();
 void updateSolar();
-int average(const int samples[MAX_SAMPLES]);
-void initializeDefaultSettings();
+void updateSerial();
+void sendTelemetry();
+uint8_t toSample(int value);
+void initializeDefaultSettings(Settings& settings);
+bool readLegacySettings(Settings& settings);
 void readSettings();
+void applySettings(const Settings& settings);
+void collectSettings(Settings& settings);
 void writeSettings();
-
-void readEncoder()
+void updateSettings();
+
+int temperatureReading(uint8_t);
+int temperatureSetting(uint8_t);
+void editTemperature(uint8_t, int value);
+int humidityReading(uint8_t);
+int humiditySetting(uint8_t);
+void editHumidity(uint8_t, int value);
+int solarReading(uint8_t);
+int solarSetting(uint8_t);
+void editSolar(uint8_t, int value);
+int fanDutyPercent(uint8_t fan);
+int fanOption(uint8_t fan);
+void editFanOption(uint8_t fan, int value);
+int powerSetting(uint8_t);
+void editPower(uint8_t, int value);
+int historyReading(uint8_t series);
+int historySetting(uint8_t);
+
+// S C R E E N S
+
+static const char titleTemperature[] PROGMEM = "Temperature";
+static const char titleHumidity[] PROGMEM = "Humidity";
+static const char titleSolar[] PROGMEM = "Solar";
+static const char titleFan[] PROGMEM = "Fan ";
+static const char titlePower[] PROGMEM = "Power";
+static const char titleTrend[] PROGMEM = "Trend ";
+
+// Shown after titleTrend, in HISTORY_* series order
+static const char trendTemperature[] PROGMEM = "Temp";
+static const char trendHumidity[] PROGMEM = "RH";
+static const char trendSolar[] PROGMEM = "Solar";
+
+static const char* const trendLabels[HISTORY_SERIES] PROGMEM =
 {
-    // Encoder interrupt routine for both pins. Updates counter
-    // if they are valid and have rotated a full indent.
-
-    static uint8_t old_AB = 3; // Lookup table index
-    static int8_t  encval = 0; // Encoder value
-    static const int8_t  enc_states[] = {0,-1,1,0,1,0,0,-1,-1,0,0,1,0,1,-1,0};
-
-    old_AB <<= 2; // Remember previous state
-
-    if (digitalRead(ENC_CLK_PIN)) old_AB |= 0x02; // Add current state of pin A
-    if (digitalRead(ENC_DT_PIN)) old_AB |= 0x01; // Add current state of pin B
-
-    encval += enc_states[(old_AB & 0x0F)];
+    trendTemperature, trendHumidity, trendSolar
+};
 
-    // Update counter if encoder has rotated a full indent, this is at least 4 steps
-    if (encval > 3)
-    {
-        encDir = CW;
+// In the order the knob steps through them
+constexpr ScreenDescriptor screenTable[] PROGMEM =
+{
+    { titleTemperature, SCREEN_VALUES, 1, temperatureReading, temperatureSetting, editTemperature, 1, 99 },
+    { titleHumidity, SCREEN_VALUES, 1, humidityReading, humiditySetting, editHumidity, 1, 99 },
+    { titleSolar, SCREEN_VALUES, 1, solarReading, solarSetting, editSolar, 1, 99 },
+    { titleFan, SCREEN_FAN, FAN_COUNT, fanDutyPercent, fanOption, editFanOption, FAN_OFF, FAN_AUTO },
+    { titlePower, SCREEN_POWER, 1, nullptr, powerSetting, editPower, POWER_OFF, POWER_SOLAR },
+    { titleTrend, SCREEN_HISTORY, HISTORY_SERIES, historyReading, historySetting, nullptr, 0, 0 }
+};
 
-        int changeValue = 1;
-        if ((micros() - encLastIncTime) < encPauseLength)
-        {
-            changeValue = 10 * changeValue;
-        }
+constexpr uint8_t SCREEN_ROWS = sizeof(screenTable) / sizeof(screenTable[0]);
 
-        encLastIncTime = micros();
-        encCnt = encCnt + changeValue;
-        encval = 0;
-    }
-    else if (encval < -3)
-    {
-        encDir = CCW;
+constexpr int screenCount(uint8_t row = 0)
+{
+    return (row < SCREEN_ROWS) ? screenTable[row].count + screenCount(row + 1) : 0;
+}
 
-        int changeValue = -1;
-        if ((micros() - encLastDecTime) < encPauseLength)
-        {
-            changeValue = 10 * changeValue;
-        }
+constexpr int SCREEN_COUNT = screenCount();
 
-        encLastDecTime = micros();
-        encCnt = encCnt + changeValue;
-        encval = 0;
-    }
-}
+static_assert(SCREEN_COUNT <= 255, "Telemetry sends the screen as a byte");
 
 void setup()
 {
-    currentScreen = SCRN_TEMP;
-
-    initializeDefaultSettings();
+    currentScreen = SCRN_FIRST;
 
+    beginFanChannels();
     readSettings();
 
     lastTemperature = 0;
@@ -204,301 +395,739 @@ void setup()
 
     editMode = false;
 
-    Serial.begin(9600);
+    Serial.begin(SERIAL_BAUD);
+
+    // A trace starts from the settings, then the readings below
+    Settings settings;
+    collectSettings(settings);
+    traceBoot(settings);
 
     // Initialize PIN configurations
-    attachInterrupt(digitalPinToInterrupt(ENC_CLK_PIN), readEncoder, CHANGE); // ENC_A
-    attachInterrupt(digitalPinToInterrupt(ENC_DT_PIN), readEncoder, CHANGE);  // ENC_B
-    pinMode(ENC_SW_PIN, INPUT_PULLUP);
-
-    pinMode(FAN1_PIN, OUTPUT);
-    pinMode(FAN2_PIN, OUTPUT);
-    pinMode(FAN3_PIN, OUTPUT);
-    pinMode(FAN4_PIN, OUTPUT);
-    digitalWrite(FAN1_PIN, 0);
-    digitalWrite(FAN2_PIN, 0);
-    digitalWrite(FAN3_PIN, 0);
-    digitalWrite(FAN4_PIN, 0);
-
-    display.begin(SSD1306_SWITCHCAPVCC, 0x3C); // Address 0x3C for 128x32
-    display.clearDisplay();
+    encoderBegin(knobTurned);
+    buttonBegin(buttonPressed);
+
+    // Sleep between sensor readings, the encoder and button wake us up
+    powerBegin(inputChanged);
+
+    fanOutputBegin();
+
+    // Without a panel the fans still run, telemetry reports it missing
+    displayFound = display.begin(SCREEN_ADDRESS);
 
     // Read current temp and humidity...
-    dht.begin();
-    currentHumidity = dht.readHumidity();
-    currentTemperature = dht.readTemperature();
-    currentTemperatureInt = static_cast<int>(dht.convertCtoF(currentTemperature));
-    currentHumidityInt = static_cast<int>(currentHumidity);
+    dhtBegin();
 
-    // Build the initial averaging array
-    temperatureIndex = 0;
-    for (int & temperatureSample : temperatureSamples)
-        temperatureSample = currentTemperatureInt;
+    // The sensor wants about a second after power up, so this often fails.
+    // Then the averages are seeded from the first reading updateDHT() gets.
+    DhtSample sample;
+    if (dhtWaitForSample(sample, DHT_BOOT_TIMEOUT))
+    {
+        traceDht(sample);
+        seedDhtReadings(sample);
+    }
 
     // Read current solar...
-    currentSolar = static_cast<int>(static_cast<float>(analogRead(SOLAR_PIN)) / 10.23f);
+    uint16_t reading;
+    solarAdcBegin();
+    solarAdcStart();
+    while (!solarAdcRead(reading))
+        delay(1);
+
+    traceSolar(reading);
+
+    currentSolar = adcToPercent(reading);
 
     // Build the initial averaging array
-    solarIndex = 0;
-    for (int & solarSample : solarSamples)
-        solarSample = currentSolar;
+    solarSamples.fill(toSample(currentSolar));
+
+    // Start the history with the first readings
+    historyBegin();
+    addHistorySample();
+
+    inputTask = schedulerAdd(updateInput, INPUT_DELAY);
+    dhtTask = schedulerAdd(updateDHT, DHT_DELAY);
+    solarTask = schedulerAdd(updateSolar, SOLAR_DELAY);
+    displayTask = schedulerAdd(updateDisplay, DISPLAY_DELAY);
+    fanTask = schedulerAdd(updateAllFans, FAN_DELAY);
+    serialTask = schedulerAdd(updateSerial, SERIAL_DELAY);
+    settingsTask = schedulerAdd(updateSettings, SETTINGS_DELAY);
+    telemetryTask = schedulerAdd(sendTelemetry, TELEMETRY_DELAY);
+    historyTask = schedulerAdd(updateHistory, HISTORY_DELAY);
 }
 
 void loop()
 {
-    int reading = updateEditMode();
+    // Run whatever is due, then sleep until the next task or an input
+    schedulerRunDue();
+
+    // PWM stops with the timers, fans at part speed need idle sleep
+    if (fanOutputPwmActive())
+        powerKeepClocked();
+
+    // So does the button debounce tick on Timer2
+    if (buttonBusy())
+        powerKeepClocked();
+
+    powerWakeWithin(schedulerMillisUntilNext());
+    powerSleep();
+}
+
+void knobTurned()
+{
+    // Called from the encoder interrupt, handle the detent on the next pass
+    schedulerTrigger(inputTask);
+}
+
+void buttonPressed()
+{
+    // Called from the button tick interrupt, handle the event on the next pass
+    schedulerTrigger(inputTask);
+}
+
+void inputChanged()
+{
+    // Woken from power down by the knob or button, catch the encoder up
+    encoderChanged();
+    schedulerTrigger(inputTask);
+}
+
+void updateInput()
+{
+    updateEditMode();
     updateEncoder();
-    updateDHT();
-    updateSolar();
 
-    beginDisplay();
+    // Settings or the screen may have changed
+    schedulerTrigger(displayTask);
+    schedulerTrigger(fanTask);
+}
+
+void updateAllFans()
+{
+    PROFILE_STAGE(PROFILE_FANS);
 
-    switch (currentScreen / SCRN_CLICKS)
+    unsigned long now = millis();
+    unsigned long elapsed = min(now - lastFanMillis, static_cast<unsigned long>(PI_MAX_STEP_MILLIS));
+    lastFanMillis = now;
+
+    uint8_t autoDuty = autoFanDuty(static_cast<uint16_t>(elapsed));
+
+    // Work out every fan first, then switch them all at once
+    uint8_t duty[FAN_COUNT];
+
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+        duty[fans[fan].output] = fanTargetDuty(fans[fan], autoDuty, now);
+
+    // Spin up a step at a time, extra passes in between don't count. Only
+    // one stopped fan starts per stagger period, the rest wait their turn.
+    bool stepDue = now - lastRampMillis >= FAN_RAMP_DELAY;
+    bool startDue = now - lastStartMillis >= FAN_STAGGER_MILLIS;
+    bool ramping = false;
+    bool changed = false;
+
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
     {
-        case SCRN_TEMP:
-        {
-            displayTitle("Temperature");
-            displayValues(lastTemperature, currentTemperatureInt, setTemperature);
-        }
-        break;
+        uint8_t output = fans[fan].output;
+        uint8_t current = fanOutputDuty(output);
+        uint8_t next = rampFanDuty(current, duty[output], stepDue);
 
-        case SCRN_HUMIDITY:
+        if (current == 0 && next > 0)
         {
-            displayTitle("Humidity");
-            displayValues(lastHumidity, currentHumidityInt, setHumidity);
-        }
-        break;
+            if (startDue)
+                lastStartMillis = now;
+            else
+                next = 0;
 
-        case SCRN_SOLAR:
-        {
-            displayTitle("Solar");
-            displayValues(lastSolar, currentSolar, setSolar);
+            startDue = false;
         }
-        break;
 
-        case SCRN_FAN1:
+        // Count every start and stop, whatever asked for it
+        if ((current == 0) != (next == 0))
         {
-            displayFanTitle(SCRN_FAN1);
-            displayFanOption(fan1Option);
+            fans[fan].switchedMillis = now;
+            fans[fan].switches++;
         }
-        break;
 
-        case SCRN_FAN2:
-        {
-            displayFanTitle(SCRN_FAN2);
-            displayFanOption(fan2Option);
-        }
-        break;
+        ramping |= next != duty[output];
+        changed |= next != current;
+        duty[output] = next;
+    }
 
-        case SCRN_FAN3:
-        {
-            displayFanTitle(SCRN_FAN3);
-            displayFanOption(fan3Option);
-        }
-        break;
+    if (stepDue)
+        lastRampMillis = now;
+
+    fanOutputApply(duty);
+
+    // The fan screens show the duty
+    if (changed)
+    {
+        schedulerTrigger(displayTask);
+        traceFans();
+    }
+
+    if (ramping)
+        schedulerDelay(fanTask, FAN_RAMP_DELAY);
+}
+
+ViewModel buildViewModel()
+{
+    ViewModel view;
+
+    view.screen = currentScreen / SCRN_CLICKS;
+    view.editMode = editMode;
 
-        case SCRN_FAN4:
+    // Only capture the values the screen actually shows, so changes on
+    // other screens don't trigger a redraw.
+    uint8_t index;
+    ScreenDescriptor row = screenAt(view.screen, index);
+
+    view.currentValue = (row.current != nullptr) ? row.current(index) : 0;
+    view.setValue = row.setting(index);
+
+    return view;
+}
+
+void updateDisplay()
+{
+    if (!displayFound)
+        return;
+
+    // Draw the whole view again if any of it didn't make it to the panel
+    if (drawingPage >= display.pageCount() && !display.busy() && display.sendFailed())
+        shownViewValid = false;
+
+    // Start on the view when it changed and the last one is all drawn
+    if (drawingPage >= display.pageCount())
+    {
+        ViewModel view = buildViewModel();
+
+        // Nothing on screen changed, leave the panel alone
+        if (!shownViewValid || !(view == shownView))
         {
-            displayFanTitle(SCRN_FAN4);
-            displayFanOption(fan4Option);
+            drawingView = view;
+            drawingPage = 0;
+
+            uint8_t index;
+            if (screenAt(view.screen, index).kind == SCREEN_HISTORY)
+                snapshotHistory(index, drawingHistory);
         }
-        break;
+    }
+
+    // Draw a page at a time while there's a buffer free, the TWI interrupt
+    // sends the pages that differ from what the panel already shows
+    while (drawingPage < display.pageCount() && display.canDraw())
+    {
+        display.beginPage(drawingPage++);
+        renderView(drawingView);
+
+        PROFILE_STAGE(PROFILE_FLUSH);
+        display.endPage();
 
-        case SCRN_POWER:
+        if (drawingPage == display.pageCount())
         {
-            displayTitle("Power");
-            displayPowerOption(powerOption);
+            shownView = drawingView;
+            shownViewValid = true;
         }
+    }
+
+    // Sending needs the CPU clocked, come back for the rest of the pages
+    if (drawingPage < display.pageCount() || display.busy())
+    {
+        powerKeepClocked();
+        schedulerDelay(displayTask, DISPLAY_POLL_DELAY);
+    }
+}
+
+void renderView(const ViewModel& view)
+{
+    PROFILE_STAGE(PROFILE_RENDER);
+
+    beginDisplay(view.editMode);
+
+    uint8_t index;
+    ScreenDescriptor row = screenAt(view.screen, index);
+
+    switch (row.kind)
+    {
+        case SCREEN_VALUES:
+            displayTitle(row.title);
+            displayValues(view.currentValue, view.setValue);
+            break;
+
+        case SCREEN_FAN:
+            displayFanTitle(row.title, index);
+            displayFanOption(view.setValue, view.currentValue);
+            break;
+
+        case SCREEN_POWER:
+            displayTitle(row.title);
+            displayPowerOption(view.setValue);
             break;
 
+        case SCREEN_HISTORY:
+            displayTitle(row.title);
+            display.printProgmem(reinterpret_cast<const char*>(pgm_read_ptr(&trendLabels[index])));
+            displayHistory(index, drawingHistory);
+            break;
     }
+}
 
-    display.display();
+ScreenDescriptor screenAt(int screen, uint8_t& index)
+{
+    ScreenDescriptor row;
 
-    updateFans(FAN1_PIN, fan1Option);
-    updateFans(FAN2_PIN, fan2Option);
-    updateFans(FAN3_PIN, fan3Option);
-    updateFans(FAN4_PIN, fan4Option);
+    // Walk the rows until the one holding this screen, index is the
+    // screen's place within it
+    for (uint8_t i = 0; i < SCREEN_ROWS; i++)
+    {
+        memcpy_P(&row, &screenTable[i], sizeof(row));
 
-    lastButtonState = reading;
+        if (screen < row.count)
+            break;
+
+        screen -= row.count;
+    }
+
+    index = static_cast<uint8_t>(screen);
+    return row;
+}
+
+bool screenEditable(int screen)
+{
+    uint8_t index;
+    return screenAt(screen, index).edit != nullptr;
 }
 
-void initializeDefaultSettings()
+void editScreen(int screen, int steps)
 {
-    int id;
-    EEPROM.get(GUID_ADDR, id);
+    uint8_t index;
+    ScreenDescriptor row = screenAt(screen, index);
+
+    if (row.edit == nullptr)
+        return;
 
-    // Set defaults if not initialized yet
-    if (id != GUID)
+    int value = row.setting(index);
+
+    if (row.kind == SCREEN_VALUES)
+    {
+        // Set points move by every detent turned, up to their limits
+        value = constrain(value + steps, row.minimum, row.maximum);
+    }
+    else
     {
-        EEPROM.put(0, GUID);
-        EEPROM.write(TEMPERATURE_ADDR, 78);
-        EEPROM.write(HUMIDITY_ADDR, 85);
-        EEPROM.write(SOLAR_ADDR, 30);
-        EEPROM.write(FAN_1_ADDR, FAN_AUTO);
-        EEPROM.write(FAN_2_ADDR, FAN_AUTO);
-        EEPROM.write(FAN_3_ADDR, FAN_AUTO);
-        EEPROM.write(FAN_4_ADDR, FAN_AUTO);
-        EEPROM.write(POWER_ADDR, POWER_ON);
+        // Options move one at a time, clockwise from the last to the first
+        // (AUTO -> ON -> OFF), and wrap around
+        value += (steps > 0) ? -1 : 1;
+
+        if (value < row.minimum)
+            value = row.maximum;
+        else if (value > row.maximum)
+            value = row.minimum;
     }
+
+    row.edit(index, value);
+}
+
+int temperatureReading(uint8_t)
+{
+    return currentTemperatureInt;
+}
+
+int temperatureSetting(uint8_t)
+{
+    return setTemperature;
+}
+
+void editTemperature(uint8_t, int value)
+{
+    setTemperature = value;
+}
+
+int humidityReading(uint8_t)
+{
+    return currentHumidityInt;
+}
+
+int humiditySetting(uint8_t)
+{
+    return setHumidity;
+}
+
+void editHumidity(uint8_t, int value)
+{
+    setHumidity = value;
+}
+
+int solarReading(uint8_t)
+{
+    return currentSolar;
+}
+
+int solarSetting(uint8_t)
+{
+    return setSolar;
+}
+
+void editSolar(uint8_t, int value)
+{
+    setSolar = value;
+}
+
+int fanDutyPercent(uint8_t fan)
+{
+    return dutyToPercent(fanOutputDuty(fans[fan].output));
+}
+
+int fanOption(uint8_t fan)
+{
+    return fans[fan].option;
+}
+
+void editFanOption(uint8_t fan, int value)
+{
+    fans[fan].option = value;
+}
+
+int powerSetting(uint8_t)
+{
+    return powerOption;
+}
+
+void editPower(uint8_t, int value)
+{
+    powerOption = value;
+}
+
+int historyReading(uint8_t series)
+{
+    return historyLatest(series);
+}
+
+int historySetting(uint8_t)
+{
+    // Redraw the sparkline whenever a sample comes or goes
+    return static_cast<int>(historyRevision());
+}
+
+void initializeDefaultSettings(Settings& settings)
+{
+    settings.temperature = 78;
+    settings.humidity = 85;
+    settings.solar = 30;
+
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+        settings.fans[fan] = FAN_AUTO;
+
+    settings.power = POWER_ON;
+}
+
+bool readLegacySettings(Settings& settings)
+{
+    int16_t id;
+    EEPROM.get(LEGACY_GUID_ADDR, id);
+
+    // Not initialized by the old firmware either
+    if (id != LEGACY_GUID)
+        return false;
+
+    settings.temperature = EEPROM.read(LEGACY_TEMPERATURE_ADDR);
+    settings.humidity = EEPROM.read(LEGACY_HUMIDITY_ADDR);
+    settings.solar = EEPROM.read(LEGACY_SOLAR_ADDR);
+
+    // The old firmware only knew four fans, any more start out on AUTO
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+        settings.fans[fan] = (fan < LEGACY_FAN_COUNT) ? EEPROM.read(LEGACY_FAN_1_ADDR + fan) : FAN_AUTO;
+
+    settings.power = EEPROM.read(LEGACY_POWER_ADDR);
+
+    return true;
 }
 
 void readSettings()
 {
-    setTemperature = min(EEPROM.read(TEMPERATURE_ADDR), 99);
-    setHumidity = min(EEPROM.read(HUMIDITY_ADDR), 99);
-    setSolar = min(EEPROM.read(SOLAR_ADDR), 99);
+    Settings settings;
 
-    fan1Option = EEPROM.read(FAN_1_ADDR);
-    fan1Option = (fan1Option > 2) ? 2 : fan1Option;
-    fan2Option = EEPROM.read(FAN_2_ADDR);
-    fan2Option = (fan2Option > 2) ? 2 : fan2Option;
-    fan3Option = EEPROM.read(FAN_3_ADDR);
-    fan3Option = (fan3Option > 2) ? 2 : fan3Option;
-    fan4Option = EEPROM.read(FAN_4_ADDR);
-    fan4Option = (fan4Option > 2) ? 2 : fan4Option;
+    // Use the newest stored record, or migrate the old layout, or start
+    // from defaults. Anything that didn't come from the store is saved
+    // into it straight away.
+    if (!settingsLoad(settings))
+    {
+        if (!readLegacySettings(settings))
+            initializeDefaultSettings(settings);
 
-    powerOption = EEPROM.read(POWER_ADDR);
+        settingsSave(settings);
+    }
+
+    applySettings(settings);
+}
+
+void applySettings(const Settings& settings)
+{
+    setTemperature = min(settings.temperature, 99);
+    setHumidity = min(settings.humidity, 99);
+    setSolar = min(settings.solar, 99);
+
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+    {
+        int option = settings.fans[fans[fan].settingsSlot];
+        fans[fan].option = (option > 2) ? 2 : option;
+    }
+
+    powerOption = settings.power;
     powerOption = (powerOption > 2) ? 2 : powerOption;
 }
 
+void collectSettings(Settings& settings)
+{
+    settings.temperature = static_cast<uint8_t>(setTemperature);
+    settings.humidity = static_cast<uint8_t>(setHumidity);
+    settings.solar = static_cast<uint8_t>(setSolar);
+
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+        settings.fans[fans[fan].settingsSlot] = static_cast<uint8_t>(fans[fan].option);
+
+    settings.power = static_cast<uint8_t>(powerOption);
+}
+
 void writeSettings()
 {
-    EEPROM.write(TEMPERATURE_ADDR, static_cast<uint8_t>(setTemperature));
-    EEPROM.write(HUMIDITY_ADDR, static_cast<uint8_t>(setHumidity));
-    EEPROM.write(SOLAR_ADDR, static_cast<uint8_t>(setSolar));
-    EEPROM.write(FAN_1_ADDR, static_cast<uint8_t>(fan1Option));
-    EEPROM.write(FAN_2_ADDR, static_cast<uint8_t>(fan2Option));
-    EEPROM.write(FAN_3_ADDR, static_cast<uint8_t>(fan3Option));
-    EEPROM.write(FAN_4_ADDR, static_cast<uint8_t>(fan4Option));
-    EEPROM.write(POWER_ADDR, static_cast<uint8_t>(powerOption));
+    Settings settings;
+    collectSettings(settings);
+
+    // The store skips the write when nothing changed, otherwise the task
+    // trickles the record out a byte at a time.
+    if (settingsSave(settings))
+        schedulerTrigger(settingsTask);
 }
 
-void updateFans(int fan, int option)
+void updateSettings()
 {
-    if ((powerOption == POWER_OFF) || (powerOption == POWER_SOLAR && currentSolar <= setSolar))
+    if (settingsUpdate())
     {
-        digitalWrite(fan, LOW);
-        return;
+        powerKeepClocked();
+        schedulerDelay(settingsTask, SETTINGS_POLL_DELAY);
     }
+}
 
-    // Turn each fan on/off based on options set
-    if (option == FAN_AUTO)
+bool fansPowered()
+{
+    return !((powerOption == POWER_OFF) || (powerOption == POWER_SOLAR && currentSolar <= setSolar));
+}
+
+uint8_t autoFanDuty(uint16_t elapsedMillis)
+{
+    // Nothing can move the air, don't let the loops wind up meanwhile
+    if (!fansPowered())
     {
-        if (currentTemperatureInt >= setTemperature || currentHumidityInt >= setHumidity)
-            digitalWrite(fan, HIGH);
-        else
-            digitalWrite(fan, LOW);
+        temperatureControl.reset();
+        humidityControl.reset();
+        return 0;
     }
-    else if (option == FAN_ON)
-        digitalWrite(fan, HIGH);
-    else
-        digitalWrite(fan, LOW);
+
+    // Lead each loop by how far a rising reading will go within the
+    // horizon. A falling one isn't followed, the fans run until it's below.
+    int16_t temperatureLead = max(temperatureTrend.change(FAN_PREDICT_SAMPLES), static_cast<int16_t>(0));
+    int16_t humidityLead = max(humidityTrend.change(FAN_PREDICT_SAMPLES), static_cast<int16_t>(0));
+
+    // Both loops run all the time, whichever wants more air wins
+    int16_t temperatureError = currentTemperatureTenths + temperatureLead - setTemperature * 10;
+    int16_t humidityError = currentHumidityInt + humidityLead - setHumidity;
+
+    // Each fan decides for itself whether that's enough to start or stop it
+    return max(temperatureControl.update(temperatureError, elapsedMillis),
+               humidityControl.update(humidityError, elapsedMillis));
 }
 
-void displayValues(int lastValue, int currentValue, int setValue)
+uint8_t fanTargetDuty(const FanChannel& channel, uint8_t autoDuty, unsigned long now)
 {
-    currentValue = (currentValue < 0) ? 0 : (currentValue > 140) ? 140 : currentValue;
-    setValue = (setValue < 0) ? 0 : (setValue > 100) ? 100 : setValue;
+    if (!fansPowered())
+        return 0;
 
-    // Easy way to figure where to center text based on largest numbers
-    const char* oneDigits = "0";
-    const char* twoDigits = "00";
-    const char* threeDigits = "100";
-    const char* numText = oneDigits;
+    // Drive each fan based on options set, the user's choices take effect
+    // straight away
+    if (channel.option == FAN_AUTO)
+        return autoSwitchDuty(channel, autoDuty, now);
 
-    // Set the text size and color for displaying temperature and humidity values
-    display.setTextSize(3);
-    display.setTextColor(SSD1306_WHITE);
+    return (channel.option == FAN_ON) ? FAN_DUTY_MAX : 0;
+}
+
+uint8_t autoSwitchDuty(const FanChannel& channel, uint8_t autoDuty, unsigned long now)
+{
+    unsigned long dwell = now - channel.switchedMillis;
+
+    // A running fan keeps going through the deadband, at the slowest speed
+    // that turns it, and for at least its minimum on time
+    if (fanOutputDuty(channel.output) > 0)
+    {
+        if (autoDuty < FAN_STOP_DUTY && dwell >= FAN_MIN_ON_MILLIS)
+            return 0;
+
+        return max(autoDuty, static_cast<uint8_t>(FAN_MIN_DUTY));
+    }
+
+    // A stopped one waits for the top of the deadband and its minimum off time
+    if (autoDuty >= FAN_START_DUTY && dwell >= FAN_MIN_OFF_MILLIS)
+        return autoDuty;
+
+    return 0;
+}
 
-    numText = (currentValue < 10) ? oneDigits : (currentValue < 100) ? twoDigits : threeDigits;
+uint8_t rampFanDuty(uint8_t current, uint8_t target, bool stepDue)
+{
+    // Slowing down and stopping take effect straight away
+    if (target <= current)
+        return target;
+
+    // A stopped fan starts at the slowest speed that turns it
+    if (current == 0)
+        return min(target, static_cast<uint8_t>(FAN_MIN_DUTY));
 
-    // Get the text extents
-    int width = getTextWidth(numText);
-    int height = getTextHeight(numText);
+    if (!stepDue)
+        return current;
+
+    return (target - current > FAN_RAMP_STEP) ? current + FAN_RAMP_STEP : target;
+}
+
+int dutyToPercent(uint8_t duty)
+{
+    return (duty * 100 + FAN_DUTY_MAX / 2) / FAN_DUTY_MAX;
+}
 
-    // Figure where center is positioned
-    int x = (((display.width() / 2) - width) / 2) ;
-    int y = ((SCREEN_BOTTOM-height) / 2) + SCREEN_TOP + 2;
+void displayValues(int currentValue, int setValue)
+{
+    currentValue = (currentValue < 0) ? 0 : (currentValue > 140) ? 140 : currentValue;
+    setValue = (setValue < 0) ? 0 : (setValue > 100) ? 100 : setValue;
 
+    const int half = display.width() / 2;
     char buf[5];
 
     // Display the LEFT value centered
-    display.setCursor(x, y);
-    display.print(itoa(currentValue,buf,10));
+    itoa(currentValue, buf, 10);
+    drawBigText(display, bigTextCenter(buf, 0, half), SCREEN_VALUE_PAGE, buf);
 
     // Line between two numbers
-    display.drawLine(display.width()/2, SCREEN_TOP+1, display.width()/2, display.height()-1, SSD1306_WHITE);
-
-    numText = (setValue < 10) ? oneDigits : (setValue < 100) ? twoDigits : threeDigits;
-
-    // Get the text extents
-    width = getTextWidth(numText);
-    x = (((display.width() / 2) - width) / 2) ;
+    display.drawFastVLine(half, SCREEN_TOP + 1, display.height() - SCREEN_TOP - 1, SSD1306_WHITE);
 
     // Display the RIGHT value centered
-    display.setCursor(x + display.width()/2, y);
-    display.print(itoa(setValue,buf,10));
+    itoa(setValue, buf, 10);
+    drawBigText(display, bigTextCenter(buf, half, half), SCREEN_VALUE_PAGE, buf);
 }
 
 void displayPowerOption(int option)
 {
-    // Set the font size and color
-    display.setTextSize(3);
+    // Each word centered on the panel, positions worked out at compile time
+    constexpr int16_t solarX = bigTextCenter("SOLAR", 0, SCREEN_WIDTH);
+    constexpr int16_t onX = bigTextCenter("ON", 0, SCREEN_WIDTH);
+    constexpr int16_t offX = bigTextCenter("OFF", 0, SCREEN_WIDTH);
+
+    if (option == POWER_SOLAR)
+        drawBigText(display, solarX, SCREEN_VALUE_PAGE, "SOLAR");
+    else if (option == POWER_ON)
+        drawBigText(display, onX, SCREEN_VALUE_PAGE, "ON");
+    else
+        drawBigText(display, offX, SCREEN_VALUE_PAGE, "OFF");
+}
+
+void displayFanOption(int option, int dutyPercent)
+{
+    // Each word centered on the panel, positions worked out at compile time
+    constexpr int16_t autoX = bigTextCenter("AUTO", 0, SCREEN_WIDTH);
+    constexpr int16_t onX = bigTextCenter("ON", 0, SCREEN_WIDTH);
+    constexpr int16_t offX = bigTextCenter("OFF", 0, SCREEN_WIDTH);
+
+    // The live duty in the title bar, clear of the EDIT badge
+    char buf[5];
+    itoa(dutyPercent, buf, 10);
+    strcat(buf, "%");
+
     display.setTextColor(SSD1306_WHITE);
+    display.setCursor(SCREEN_WIDTH - 36 - getTextWidth(buf), 4);
+    display.print(buf);
+
+    if (option == FAN_AUTO)
+        drawBigText(display, autoX, SCREEN_VALUE_PAGE, "AUTO");
+    else if (option == FAN_ON)
+        drawBigText(display, onX, SCREEN_VALUE_PAGE, "ON");
+    else
+        drawBigText(display, offX, SCREEN_VALUE_PAGE, "OFF");
+}
 
-    // Determine what word to display based on the option
-    const char* autoText = "SOLAR";
-    const char* onText = "ON";
-    const char* offText = "OFF";
-    const char* displayText = (option == POWER_SOLAR) ? autoText : (option == POWER_ON) ? onText : offText;
+void snapshotHistory(uint8_t series, HistoryView& history)
+{
+    history.count = historyCount();
+
+    if (history.count == 0)
+        return;
+
+    history.minimum = historyMinimum(series);
+    history.maximum = historyMaximum(series);
+    history.mean = historyMean(series);
 
-    // Get the extents of the text for centering
-    int width = getTextWidth(displayText);
-    int height = getTextHeight(displayText);
+    int16_t range = history.maximum - history.minimum;
 
-    // Center in the display region
-    int x = (display.width() - width) / 2;
-    int y = ((SCREEN_BOTTOM-height) / 2) + SCREEN_TOP + 1;
+    // The extremes touch the top and bottom, a flat series runs through
+    // the middle
+    HistoryReader reader(series);
+    int16_t value;
+    uint8_t* row = history.rows;
 
-    // Display text in the centered position
-    display.setCursor(x, y);
-    display.print(displayText);
+    while (reader.next(value))
+    {
+        if (range > 0)
+            *row++ = SPARKLINE_HEIGHT - 1 - static_cast<int32_t>(value - history.minimum) * (SPARKLINE_HEIGHT - 1) / range;
+        else
+            *row++ = SPARKLINE_HEIGHT / 2;
+    }
 }
 
-void displayFanOption(int option)
+void displayHistory(uint8_t series, const HistoryView& history)
 {
-    // Set the font size and color
-    display.setTextSize(3);
-    display.setTextColor(SSD1306_WHITE);
+    if (history.count == 0)
+    {
+        display.setTextColor(SSD1306_WHITE);
+        display.setCursor(SPARKLINE_X, SPARKLINE_TOP);
+        display.print("No data");
+        return;
+    }
 
-    // Determine what word to display based on the option
-    const char* autoText = "AUTO";
-    const char* onText = "ON";
-    const char* offText = "OFF";
-    const char* displayText = (option == FAN_AUTO) ? autoText : (option == FAN_ON) ? onText : offText;
+    int16_t lastY = 0;
 
-    // Get the extents of the text for centering
-    int width = getTextWidth(displayText);
-    int height = getTextHeight(displayText);
+    for (uint8_t i = 0; i < history.count; i++)
+    {
+        int16_t x = SPARKLINE_X + i;
+        int16_t y = SPARKLINE_TOP + history.rows[i];
 
-    // Center in the display region
-    int x = (display.width() - width) / 2;
-    int y = ((SCREEN_BOTTOM-height) / 2) + SCREEN_TOP + 1;
+        if (i == 0)
+            display.drawPixel(x, y, SSD1306_WHITE);
+        else
+            display.drawLine(x - 1, lastY, x, y, SSD1306_WHITE);
 
-    // Display text in the centered position
-    display.setCursor(x, y);
-    display.print(displayText);
+        lastY = y;
+    }
+
+    // Maximum at the top, mean in the middle and minimum at the bottom
+    display.setTextColor(SSD1306_WHITE);
+    display.setCursor(SPARKLINE_LABEL_X, SPARKLINE_TOP);
+    printHistoryValue(series, history.maximum);
+    display.setCursor(SPARKLINE_LABEL_X, SPARKLINE_TOP + (SPARKLINE_HEIGHT - display.textHeight()) / 2);
+    printHistoryValue(series, history.mean);
+    display.setCursor(SPARKLINE_LABEL_X, SPARKLINE_TOP + SPARKLINE_HEIGHT - display.textHeight());
+    printHistoryValue(series, history.minimum);
+}
+
+void printHistoryValue(uint8_t series, int16_t value)
+{
+    // Temperature is kept in tenths, shown in whole degrees like elsewhere
+    display.print((series == HISTORY_TEMPERATURE) ? roundTenths(value) : value);
 }
 
 void displayTitle(const char* title)
 {
     display.setTextColor(SSD1306_WHITE);
     display.setCursor(4, 4); // For Title
-    display.print(title);
+    display.printProgmem(title);
 }
 
-void displayFanTitle(int fan)
+void displayFanTitle(const char* title, uint8_t fan)
 {
     // Create a filled square to represent the fan box
     display.fillRect(3,3,10,10,SSD1306_WHITE);
@@ -506,270 +1135,494 @@ void displayFanTitle(int fan)
     // Display the title adding the fan number below
     display.setTextColor(SSD1306_WHITE);
     display.setCursor(16, 4); // For Title
-    display.print("Fan ");
+    display.printProgmem(title);
+
+    display.print(fan + 1);
+
+    // Clear out a square representing the position of this fan, on a 2x2
+    // grid for four fans and a 4x4 grid for more
+    constexpr int columns = (FAN_COUNT <= 4) ? 2 : 4;
+    constexpr int cell = 8 / columns;
 
-    // Clear out a square representing the position of this fan
-    if (fan == SCRN_FAN1)
+    display.fillRect(4 + (fan % columns) * cell, 4 + (fan / columns) * cell, cell, cell, SSD1306_BLACK);
+}
+
+void beginFanChannels()
+{
+    // Fans are numbered in output order, each with its own settings slot
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
     {
-        display.print(1);
-        display.fillRect(4,4,4,4,SSD1306_BLACK);
+        fans[fan].output = fan;
+        fans[fan].settingsSlot = fan;
+        fans[fan].option = FAN_AUTO;
+
+        // Starting up counts as a stop, so a unit that keeps resetting
+        // can't chatter the fans
+        fans[fan].switchedMillis = millis();
+        fans[fan].switches = 0;
     }
-    else if (fan == SCRN_FAN2)
+
+    switchStatsMillis = millis();
+}
+
+uint8_t toSample(int value)
+{
+    // Samples are stored in a byte, readings never go outside this range
+    return static_cast<uint8_t>(constrain(value, 0, 255));
+}
+
+void updateSolar()
+{
+    PROFILE_STAGE(PROFILE_SOLAR);
+
+    // Sample a fresh block each reading, the ADC interrupt sums it in the
+    // background and needs Timer0 running until it's done.
+    uint16_t reading;
+    if (!solarAdcRead(reading))
     {
-        display.print(2);
-        display.fillRect(8, 4, 4, 4, SSD1306_BLACK);
+        if (!solarAdcBusy())
+            solarAdcStart();
+
+        powerKeepClocked();
+        schedulerDelay(solarTask, SOLAR_POLL_DELAY);
+        return;
     }
-    else if (fan == SCRN_FAN3)
+
+    traceSolar(reading);
+
+    // Average the current sample to prevent jitter, the oversampling has
+    // already taken out most of the noise.
+    currentSolar = adcToPercent(reading);
+    currentSolar = solarSamples.add(toSample(currentSolar));
+
+    if (lastSolar != currentSolar)
     {
-        display.print(3);
-        display.fillRect(4, 8, 4, 4, SSD1306_BLACK);
+        lastSolar = currentSolar;
+
+        schedulerTrigger(displayTask);
+        schedulerTrigger(fanTask);
     }
-    else
+}
+
+void addHistorySample()
+{
+    const int16_t values[HISTORY_SERIES] =
+    {
+        currentTemperatureTenths,
+        static_cast<int16_t>(currentHumidityInt),
+        static_cast<int16_t>(currentSolar)
+    };
+
+    historyAdd(values);
+    lastHistoryMillis = millis();
+}
+
+void updateHistory()
+{
+#ifdef HISTORY_EEPROM
+    // A block that left the window goes out to EEPROM a byte at a time
+    if (historyUpdate())
     {
-        display.print(4);
-        display.fillRect(8, 8, 4, 4, SSD1306_BLACK);
+        powerKeepClocked();
+        schedulerDelay(historyTask, HISTORY_POLL_DELAY);
+        return;
     }
+#endif
+
+    if (millis() - lastHistoryMillis < HISTORY_INTERVAL_MILLIS)
+        return;
+
+    addHistorySample();
+    schedulerTrigger(displayTask);
+
+#ifdef HISTORY_EEPROM
+    // Start archiving straight away if a block was dropped
+    schedulerTrigger(historyTask);
+#endif
 }
 
-int average(const int samples[MAX_SAMPLES])
+void seedDhtReadings(const DhtSample& sample)
 {
-    int sum = 0;
-    for (int i = 0; i < MAX_SAMPLES; i++)
-        sum += samples[i];
-    return sum / MAX_SAMPLES;
+    lastTemperature = sample.temperatureTenths;
+    lastHumidity = sample.humidity;
+
+    currentTemperatureTenths = celsiusToFahrenheitTenths(sample.temperatureTenths);
+    currentTemperatureInt = roundTenths(currentTemperatureTenths);
+    currentHumidityInt = sample.humidity;
+
+    // Build the initial averaging array
+    temperatureSamples.fill(currentTemperatureTenths);
+
+    // Both trends start flat
+    temperatureTrend.fill(currentTemperatureTenths);
+    humidityTrend.fill(currentHumidityInt);
+    lastTrendMillis = millis();
+
+    dhtSeeded = true;
 }
 
-void updateSolar()
+void updateDHT()
 {
-    // Update the temperature and humidity readings
-    static unsigned long lastReading = 0L;
-    unsigned long thisMicros = micros();
+    PROFILE_STAGE(PROFILE_DHT);
+
+    // Start a reading when the sensor is ready, the driver captures the
+    // response in the background.
+    if (!dhtBusy() && !dhtStartReading())
+    {
+        schedulerDelay(dhtTask, DHT_RETRY_DELAY);
+        return;
+    }
+
+    dhtUpdate();
 
-    // We only want to update the temperature and humidity when the sensor is ready.
-    if (thisMicros - lastReading > SOLAR_DELAY || thisMicros < lastReading)
+    // The capture needs the timers running, keep checking until it's done
+    if (dhtBusy())
     {
+        powerKeepClocked();
+        schedulerDelay(dhtTask, DHT_POLL_DELAY);
+        return;
+    }
+
+    DhtSample sample;
+    if (!dhtReadSample(sample))
+        return;
+
+    traceDht(sample);
+
+    if (!dhtSeeded)
+        seedDhtReadings(sample);
+
+    if (lastTemperature != sample.temperatureTenths)
+    {
+        lastTemperature = sample.temperatureTenths;
+
         // Average the current sample to prevent jitter
-        currentSolar = static_cast<int>(static_cast<float>(analogRead(SOLAR_PIN)) / 20.46f) * 2;
-        solarIndex = (solarIndex + 1 >= MAX_SAMPLES) ? 0 : solarIndex + 1;
-        solarSamples[solarIndex] = currentSolar;
-        currentSolar = average(solarSamples);
+        currentTemperatureTenths = temperatureSamples.add(celsiusToFahrenheitTenths(sample.temperatureTenths));
+        currentTemperatureInt = roundTenths(currentTemperatureTenths);
+    }
 
-        if (lastSolar != currentSolar)
-            lastSolar = currentSolar;
+    if (lastHumidity != sample.humidity)
+    {
+        lastHumidity = sample.humidity;
+        currentHumidityInt = sample.humidity;
+    }
+
+    // The averages above only move when the reading does, the trends need
+    // evenly spaced samples
+    if (millis() - lastTrendMillis >= TREND_INTERVAL_MILLIS)
+    {
+        lastTrendMillis += TREND_INTERVAL_MILLIS;
+
+        // After a run of failed readings, start the spacing again from now
+        // rather than catch up with samples only a reading apart
+        if (millis() - lastTrendMillis >= TREND_INTERVAL_MILLIS)
+            lastTrendMillis = millis();
 
-        lastReading = micros();
+        temperatureTrend.add(celsiusToFahrenheitTenths(sample.temperatureTenths));
+        humidityTrend.add(sample.humidity);
     }
+
+    schedulerTrigger(displayTask);
+    schedulerTrigger(fanTask);
 }
 
-void updateDHT()
+void updateEncoder()
 {
-    // Update the temperature and humidity readings
-    static unsigned long lastReading = 0L;
-    unsigned long thisMicros = micros();
+    PROFILE_STAGE(PROFILE_ENCODER);
 
-    // We only want to update the temperature and humidity when the sensor is ready.
-    if (thisMicros - lastReading > DHT_DELAY || thisMicros < lastReading)
+    EncoderEvent event;
+
+    // Apply every detent exactly once, in the order the knob was turned
+    while (encoderReadEvent(event))
     {
-        currentHumidity = dht.readHumidity();
-        currentTemperature = dht.readTemperature();
+        traceDetent(event.steps);
 
-        if (lastTemperature != static_cast<int>(currentTemperature))
+        if (editMode)
         {
-            lastTemperature = static_cast<int>(currentTemperature);
-            currentTemperatureInt = static_cast<int>(dht.convertCtoF(currentTemperature));
-
-            // Average the current sample to prevent jitter
-            temperatureIndex = (temperatureIndex + 1 >= MAX_SAMPLES) ? 0 : temperatureIndex + 1;
-            temperatureSamples[temperatureIndex] = currentTemperatureInt;
-            currentTemperatureInt = average(temperatureSamples);
+            // In edit mode change the current screen's setting, it's saved
+            // to EEPROM for when the unit restarts
+            editScreen(currentScreen / SCRN_CLICKS, event.steps);
         }
-
-        if (lastHumidity != static_cast<int>(currentHumidity))
+        else if (event.steps > 0) // CW
         {
-            lastHumidity = static_cast<int>(currentHumidity);
-            currentHumidityInt = static_cast<int>(currentHumidity);
+            // When not in edit mode, advance to the next screen
+            currentScreen++;
+
+            if (currentScreen >= SCREEN_COUNT * SCRN_CLICKS)
+                currentScreen = SCRN_FIRST;
         }
+        else // CCW
+        {
+            // When not in edit mode, go to the prior screen
+            currentScreen--;
 
-        lastReading = micros();
+            if (currentScreen < 0)
+                currentScreen = SCREEN_COUNT * SCRN_CLICKS - 1;
+        }
     }
 }
 
-void updateEncoder()
+void updateEditMode()
 {
-    // The encoder shaft was moved
-    if (encCnt != encCntLast)
+    PROFILE_STAGE(PROFILE_EDIT_MODE);
+
+    ButtonEvent event;
+
+    // The button interrupt has already debounced and timed each gesture
+    while (buttonReadEvent(event))
     {
-        if (encDir == CW)
+        traceButton(event);
+
+        if (event == BUTTON_PRESS)
         {
-            if (!editMode)
+            // Toggle the edit mode, screens with nothing to edit stay put
+            if (editMode || screenEditable(currentScreen / SCRN_CLICKS))
             {
-                // When not in edit mode, advance to the next screen
-                currentScreen++;
+                editMode = !editMode;
 
-                if (currentScreen > SCRN_LAST * SCRN_CLICKS)
-                    currentScreen = SCRN_FIRST;
-            }
-            else
-            {
-                // In edit mode check which screen and preform forward edit, store the new
-                // value in EEPROM for when the unit restarts
-                switch (currentScreen / SCRN_CLICKS)
-                {
-                    case SCRN_TEMP:
-                        setTemperature = (setTemperature == 99) ? 99 : setTemperature + 1;
-                        break;
-                    case SCRN_HUMIDITY:
-                        setHumidity = (setHumidity == 99) ? 99 : setHumidity + 1;
-                        break;
-                    case SCRN_SOLAR:
-                        setSolar = (setSolar == 99) ? 99 : setSolar + 1;
-                        break;
-                    case SCRN_FAN1:
-                        fan1Option = updateFanOptionForward(fan1Option);
-                        break;
-                    case SCRN_FAN2:
-                        fan2Option = updateFanOptionForward(fan2Option);
-                        break;
-                    case SCRN_FAN3:
-                        fan3Option = updateFanOptionForward(fan3Option);
-                        break;
-                    case SCRN_FAN4:
-                        fan4Option =updateFanOptionForward(fan4Option);
-                        break;
-                    case SCRN_POWER:
-                        powerOption = updatePowerOptionForward(powerOption);
-                        break;
-                }
+                // Going in, remember the settings for a cancel. When coming
+                // out of edit mode, save the users settings.
+                if (editMode)
+                    collectSettings(editStart);
+                else
+                    writeSettings();
             }
         }
-        else // CCW
+        else if (event == BUTTON_LONG_PRESS)
         {
-            if (!editMode)
+            // Cancel the edit, putting back the settings it started from
+            if (editMode)
             {
-                // When not in edit mode, go to the prior screen
-                currentScreen--;
-
-                if (currentScreen < 0)
-                    currentScreen = SCRN_LAST;
+                applySettings(editStart);
+                editMode = false;
             }
-            else
+        }
+        else // BUTTON_DOUBLE_PRESS
+        {
+            // Back to the first screen, saving any edit in progress
+            if (editMode)
             {
-                // In edit mode check which screen and preform backward edit, store the new
-                // value in EEPROM for when the unit restarts
-                switch (currentScreen / SCRN_CLICKS)
-                {
-                    case SCRN_TEMP:
-                        setTemperature = (setTemperature <= 1) ? 1 : setTemperature - 1;
-                        break;
-                    case SCRN_HUMIDITY:
-                        setHumidity = (setHumidity <= 1) ? 1 : setHumidity - 1;
-                        break;
-                    case SCRN_SOLAR:
-                        setSolar = (setSolar <= 1) ? 1 : setSolar - 1;
-                        break;
-                    case SCRN_FAN1:
-                        fan1Option = updateFanOptionBackward(fan1Option);
-                        break;
-                    case SCRN_FAN2:
-                        fan2Option = updateFanOptionBackward(fan2Option);
-                        break;
-                    case SCRN_FAN3:
-                        fan3Option = updateFanOptionBackward(fan3Option);
-                        break;
-                    case SCRN_FAN4:
-                        fan4Option = updateFanOptionBackward(fan4Option);
-                        break;
-                    case SCRN_POWER:
-                        powerOption = updatePowerOptionBackward(powerOption);
-                        break;
-                }
+                editMode = false;
+                writeSettings();
             }
+
+            currentScreen = SCRN_FIRST;
         }
 
-        encCntLast = encCnt;
+        // Report the new mode straight away
+        schedulerTrigger(telemetryTask);
     }
 }
 
-int updateFanOptionForward(int option)
+void updateSerial()
 {
-    // Move the fan options forward: AUTO -> ON -> OFF -> repeat
-    if (option == FAN_AUTO)
-        return FAN_ON;
-    else if (option == FAN_ON)
-        return FAN_OFF;
-    else
-        return FAN_AUTO;
-}
+    // Keep the telemetry moving without waiting on the UART
+    telemetryFlush();
 
-int updateFanOptionBackward(int option)
-{
-    // Move the fan options backward: AUTO -> OFF -> ON -> repeat
-    if (option == FAN_AUTO)
-        return FAN_OFF;
-    else if (option == FAN_OFF)
-        return FAN_ON;
-    else
-        return FAN_AUTO;
-}
+    // Single character commands from the serial monitor. Their replies are
+    // text, so finish any frame in progress first.
+    if (Serial.available() > 0)
+        telemetryDrain();
 
-int updatePowerOptionForward(int option)
-{
-    // Move the fan options forward: SOLAR -> ON -> OFF -> repeat
-    if (option == POWER_SOLAR)
-        return POWER_ON;
-    else if (option == POWER_ON)
-        return POWER_OFF;
-    else
-        return POWER_SOLAR;
+    while (Serial.available() > 0)
+    {
+        switch (Serial.read())
+        {
+            case 'd':
+                // Report how much of the time the controller was awake
+                Serial.print("AWAKE ");
+                Serial.print(powerAwakePercent());
+                Serial.println("%");
+                powerResetStats();
+                break;
+
+            case 'h':
+                printHistory();
+                break;
+
+            case 's':
+                printTaskStats();
+                schedulerResetStats();
+                break;
+
+            case 'f':
+                printFanSwitches();
+                resetFanSwitches();
+                break;
+
+#ifdef PROFILE_STAGES
+            case 'p':
+                printProfile();
+                profilerReset();
+                break;
+#endif
+        }
+    }
 }
 
-int updatePowerOptionBackward(int option)
+void sendTelemetry()
 {
-    // Move the fan options backward: SOLAR -> OFF -> ON -> repeat
-    if (option == POWER_SOLAR)
-        return POWER_OFF;
-    else if (option == POWER_OFF)
-        return POWER_ON;
-    else
-        return POWER_SOLAR;
+    TelemetryStatus status;
+
+    status.temperatureTenths = currentTemperatureTenths;
+    status.humidity = static_cast<uint8_t>(currentHumidityInt);
+    status.solar = static_cast<uint8_t>(currentSolar);
+    status.setTemperature = static_cast<uint8_t>(setTemperature);
+    status.setHumidity = static_cast<uint8_t>(setHumidity);
+    status.setSolar = static_cast<uint8_t>(setSolar);
+    status.fans = fanOutputMask();
+    status.power = static_cast<uint8_t>(powerOption);
+    status.flags = (editMode ? TELEMETRY_FLAG_EDIT : 0) | (displayFound ? 0 : TELEMETRY_FLAG_NO_DISPLAY);
+    status.screen = static_cast<uint8_t>(currentScreen / SCRN_CLICKS);
+    status.uptimeMillis = millis();
+
+    telemetrySend(TELEMETRY_STATUS, &status, sizeof(status));
+
+    // Start sending now rather than on the next serial pass
+    schedulerTrigger(serialTask);
 }
 
-int updateEditMode()
+void printHistory()
 {
-    // Check for encoder knob push (debouncing), and toggle edit mode on/off
-    int reading = digitalRead(ENC_SW_PIN);
-
-    // reset the debouncing timer
-    if (reading != lastButtonState)
-        lastDebounceTime = millis();
+    // One line per sample, oldest first: archived blocks and then the
+    // window, temperature in Fahrenheit tenths
+#ifdef HISTORY_EEPROM
+    HistoryBlock block;
 
-    if ((millis() - lastDebounceTime) > debounceDelay)
+    for (uint8_t i = 0; i < historyArchiveCount(); i++)
     {
-        if (reading != buttonState)
+        if (!historyArchiveRead(i, block))
+            continue;
+
+        int16_t values[HISTORY_SERIES];
+        memcpy(values, block.first, sizeof(values));
+
+        for (uint8_t sample = 0; sample < HISTORY_BLOCK_SAMPLES; sample++)
         {
-            buttonState = reading;
+            Serial.print("ARCHIVE ");
+            Serial.print(block.sequence);
 
-            // Toggle the edit mode
-            if (buttonState == LOW)
+            for (uint8_t series = 0; series < HISTORY_SERIES; series++)
             {
-                editMode = !editMode;
+                if (sample > 0)
+                    values[series] += block.steps[series][sample - 1];
 
-                // When coming out of edit mode, save the users settings.
-                if (!editMode)
-                    writeSettings();
+                Serial.print(' ');
+                Serial.print(values[series]);
             }
 
-            Serial.println((editMode) ? "EDIT" : "DISPLAY");
+            Serial.println();
+        }
+    }
+#endif
+
+    HistoryReader temperature(HISTORY_TEMPERATURE);
+    HistoryReader humidity(HISTORY_HUMIDITY);
+    HistoryReader solar(HISTORY_SOLAR);
+    int16_t values[HISTORY_SERIES];
+
+    while (temperature.next(values[HISTORY_TEMPERATURE]) &&
+           humidity.next(values[HISTORY_HUMIDITY]) && solar.next(values[HISTORY_SOLAR]))
+    {
+        Serial.print("HISTORY");
+
+        for (uint8_t series = 0; series < HISTORY_SERIES; series++)
+        {
+            Serial.print(' ');
+            Serial.print(values[series]);
         }
+
+        Serial.println();
+    }
+
+    // Then the summaries kept alongside
+    for (uint8_t series = 0; series < HISTORY_SERIES; series++)
+    {
+        Serial.print("RANGE ");
+        Serial.print(series);
+        Serial.print(" min=");
+        Serial.print(historyMinimum(series));
+        Serial.print(" mean=");
+        Serial.print(historyMean(series));
+        Serial.print(" max=");
+        Serial.println(historyMaximum(series));
+    }
+}
+
+void printTaskStats()
+{
+    // One line per task in the order they were added, then the overall load
+    for (uint8_t task = 0; task < schedulerTaskCount(); task++)
+    {
+        const TaskStats& stats = schedulerStats(task);
+
+        Serial.print("TASK ");
+        Serial.print(task);
+        Serial.print(" runs=");
+        Serial.print(stats.runs);
+        Serial.print(" overruns=");
+        Serial.print(stats.overruns);
+        Serial.print(" late=");
+        Serial.print(stats.maxLateMillis);
+        Serial.print("ms run=");
+        Serial.print(stats.maxRunMicros);
+        Serial.println("us");
     }
 
-    return reading;
+    Serial.print("LOAD ");
+    Serial.print(schedulerLoadPercent());
+    Serial.println("%");
 }
 
-void beginDisplay()
+void printFanSwitches()
+{
+    // One line per fan with its starts and stops, then the time they cover
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+    {
+        Serial.print("FAN ");
+        Serial.print(fan + 1);
+        Serial.print(" switches=");
+        Serial.println(fans[fan].switches);
+    }
+
+    Serial.print("OVER ");
+    Serial.print((millis() - switchStatsMillis) / 1000);
+    Serial.println("s");
+}
+
+void resetFanSwitches()
+{
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+        fans[fan].switches = 0;
+
+    switchStatsMillis = millis();
+}
+
+#ifdef PROFILE_STAGES
+void printProfile()
+{
+    // One line per stage, in CPU cycles
+    for (uint8_t stage = 0; stage < PROFILE_STAGE_COUNT; stage++)
+    {
+        const StageStats& stats = profilerStats(stage);
+
+        Serial.print("STAGE ");
+        Serial.print(profilerStageName(stage));
+        Serial.print(" n=");
+        Serial.print(stats.count);
+        Serial.print(" min=");
+        Serial.print(stats.minCycles);
+        Serial.print(" avg=");
+        Serial.print(profilerAverageCycles(stage));
+        Serial.print(" max=");
+        Serial.println(stats.maxCycles);
+    }
+}
+#endif
+
+void beginDisplay(bool edit)
 {
     // Display consistent display items here
-    display.clearDisplay();
 
     // Normal 5x7 font
     display.setTextSize(1);
@@ -780,7 +1633,7 @@ void beginDisplay()
     // Bottom blue rect.
     display.drawRect(0,SCREEN_TOP+1, display.width()-1, (display.height()-SCREEN_TOP)-1, SSD1306_WHITE);
 
-    if (editMode)
+    if (edit)
     {
         // Display the "EDIT" symbol when in edit mode
         const int margin = 2;
@@ -800,20 +1653,13 @@ void beginDisplay()
 
 int getTextWidth(const char* text)
 {
-    int16_t x, y;
-    uint16_t w, h;
-
-    display.getTextBounds(text, 0, 0, &x, &y, &w, &h);
-
-    return static_cast<int>(w);
+    return display.textWidth(text);
 }
 
 int getTextHeight(const char* text)
 {
-    int16_t x, y;
-    uint16_t w, h;
-
-    display.getTextBounds(text, 0, 0, &x, &y, &w, &h);
+    // Every line of text is the same height
+    (void)text;
 
-    return static_cast<int>(h);
+    return display.textHeight();
 }
@@ -0,0 +1,421 @@
+#include "page_display.h"
+
+#include "display_pages.h"
+#include "twi_async.h"
+
+#define PAGE_HEIGHT 8
+
+// The setup takes under a millisecond at 400kHz, a bus held low never ends
+#define BEGIN_TIMEOUT_MILLIS 50
+
+// Character cell of the built in font, glyphs are 5x7 plus spacing
+#define FONT_WIDTH 5
+#define FONT_CELL_WIDTH 6
+#define FONT_CELL_HEIGHT 8
+
+// I2C control bytes that mark the following bytes as commands or data
+#define CONTROL_COMMANDS 0x00
+#define CONTROL_DATA 0x40
+
+#define SSD1306_MEMORYMODE 0x20
+#define SSD1306_COLUMNADDR 0x21
+#define SSD1306_PAGEADDR 0x22
+
+// Panel setup, the same sequence the Adafruit library sends for a 128x64
+// panel powered from its own charge pump. Rows and COM pins are patched in
+// for shorter panels.
+#define INIT_MULTIPLEX 4
+#define INIT_COM_PINS 15
+
+static const uint8_t initCommands[] PROGMEM =
+{
+    0xAE,               // Display off
+    0xD5, 0x80,         // Clock divide
+    0xA8, 63,           // Multiplex, rows - 1
+    0xD3, 0x00,         // Display offset
+    0x40,               // Start line 0
+    0x8D, 0x14,         // Charge pump on
+    SSD1306_MEMORYMODE, 0x00,   // Horizontal addressing
+    0xA1,               // Segment remap
+    0xC8,               // COM scan from the bottom
+    0xDA, 0x12,         // COM pins
+    0x81, 0xCF,         // Contrast
+    0xD9, 0xF1,         // Precharge
+    0xDB, 0x40,         // VCOMH deselect level
+    0xA4,               // Show RAM contents
+    0xA6,               // Not inverted
+    0x2E,               // No scrolling
+    0xAF                // Display on
+};
+
+// Only the characters the screens use are stored, anything else draws as
+// a space. Columns left to right, least significant bit at the top.
+static const char fontCharacters[] PROGMEM = " %-0123456789ADEFHILNOPRSTUadeilmnoprtuwy";
+
+static const uint8_t fontGlyphs[][FONT_WIDTH] PROGMEM =
+{
+    { 0x00, 0x00, 0x00, 0x00, 0x00 },   // space
+    { 0x23, 0x13, 0x08, 0x64, 0x62 },   // %
+    { 0x08, 0x08, 0x08, 0x08, 0x08 },   // -
+    { 0x3E, 0x51, 0x49, 0x45, 0x3E },   // 0
+    { 0x00, 0x42, 0x7F, 0x40, 0x00 },   // 1
+    { 0x42, 0x61, 0x51, 0x49, 0x46 },   // 2
+    { 0x21, 0x41, 0x45, 0x4B, 0x31 },   // 3
+    { 0x18, 0x14, 0x12, 0x7F, 0x10 },   // 4
+    { 0x27, 0x45, 0x45, 0x45, 0x39 },   // 5
+    { 0x3C, 0x4A, 0x49, 0x49, 0x30 },   // 6
+    { 0x01, 0x71, 0x09, 0x05, 0x03 },   // 7
+    { 0x36, 0x49, 0x49, 0x49, 0x36 },   // 8
+    { 0x06, 0x49, 0x49, 0x29, 0x1E },   // 9
+    { 0x7E, 0x11, 0x11, 0x11, 0x7E },   // A
+    { 0x7F, 0x41, 0x41, 0x22, 0x1C },   // D
+    { 0x7F, 0x49, 0x49, 0x49, 0x41 },   // E
+    { 0x7F, 0x09, 0x09, 0x09, 0x01 },   // F
+    { 0x7F, 0x08, 0x08, 0x08, 0x7F },   // H
+    { 0x00, 0x41, 0x7F, 0x41, 0x00 },   // I
+    { 0x7F, 0x40, 0x40, 0x40, 0x40 },   // L
+    { 0x7F, 0x04, 0x08, 0x10, 0x7F },   // N
+    { 0x3E, 0x41, 0x41, 0x41, 0x3E },   // O
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 },   // P
+    { 0x7F, 0x09, 0x19, 0x29, 0x46 },   // R
+    { 0x46, 0x49, 0x49, 0x49, 0x31 },   // S
+    { 0x01, 0x01, 0x7F, 0x01, 0x01 },   // T
+    { 0x3F, 0x40, 0x40, 0x40, 0x3F },   // U
+    { 0x20, 0x54, 0x54, 0x54, 0x78 },   // a
+    { 0x38, 0x44, 0x44, 0x48, 0x7F },   // d
+    { 0x38, 0x54, 0x54, 0x54, 0x18 },   // e
+    { 0x00, 0x44, 0x7D, 0x40, 0x00 },   // i
+    { 0x00, 0x41, 0x7F, 0x40, 0x00 },   // l
+    { 0x7C, 0x04, 0x18, 0x04, 0x78 },   // m
+    { 0x7C, 0x08, 0x04, 0x04, 0x78 },   // n
+    { 0x38, 0x44, 0x44, 0x44, 0x38 },   // o
+    { 0x7C, 0x14, 0x14, 0x14, 0x08 },   // p
+    { 0x7C, 0x08, 0x04, 0x04, 0x08 },   // r
+    { 0x04, 0x3F, 0x44, 0x40, 0x20 },   // t
+    { 0x3C, 0x40, 0x40, 0x20, 0x7C },   // u
+    { 0x3C, 0x40, 0x30, 0x40, 0x3C },   // w
+    { 0x0C, 0x50, 0x50, 0x50, 0x3C }    // y
+};
+
+static_assert(sizeof(fontCharacters) - 1 == sizeof(fontGlyphs) / FONT_WIDTH, "One glyph per font character");
+static_assert(sizeof(initCommands) <= PAGE_DISPLAY_MAX_WIDTH, "Setup is sent from a page buffer");
+
+// Each queued page is two transfers, endPage() must never wait for room
+static_assert(PAGE_DISPLAY_BUFFERS * 2 <= TWI_QUEUE_SIZE, "TWI queue too small for the page buffers");
+
+static const uint8_t* findGlyph(char c)
+{
+    for (uint8_t i = 0; i < sizeof(fontCharacters) - 1; i++)
+    {
+        if (static_cast<char>(pgm_read_byte(fontCharacters + i)) == c)
+            return fontGlyphs[i];
+    }
+
+    return fontGlyphs[0];
+}
+
+PageDisplay::PageDisplay(uint8_t width, uint8_t height)
+    : address(0), sendErrors(0), screenWidth(min(width, PAGE_DISPLAY_MAX_WIDTH)), screenHeight(height),
+      page(0), pageTop(0), drawing(0), buffer(buffers[0].pixels),
+      cursorX(0), cursorY(0), textSize(1), textColor(SSD1306_WHITE)
+{
+    for (uint8_t i = 0; i < PAGE_DISPLAY_BUFFERS; i++)
+        buffers[i].queued = false;
+}
+
+bool PageDisplay::begin(uint8_t i2cAddress)
+{
+    address = i2cAddress;
+
+    twiBegin();
+
+    // Borrow a page buffer to send the setup from, and wait for it here
+    uint8_t* commands = buffers[0].pixels;
+    memcpy_P(commands, initCommands, sizeof(initCommands));
+
+    commands[INIT_MULTIPLEX] = screenHeight - 1;
+    commands[INIT_COM_PINS] = (screenHeight > 32) ? 0x12 : 0x02;
+
+    uint16_t errors = twiErrorCount();
+    unsigned long start = millis();
+
+    uint8_t ticket = twiSubmit(address, CONTROL_COMMANDS, commands, sizeof(initCommands));
+    while (!twiDone(ticket))
+    {
+        if (millis() - start > BEGIN_TIMEOUT_MILLIS)
+            return false;
+    }
+
+    // Whatever the panel RAM holds now isn't what we drew
+    invalidate();
+    sendErrors = twiErrorCount();
+
+    // No panel at the address doesn't acknowledge
+    return sendErrors == errors;
+}
+
+bool PageDisplay::bufferFree(uint8_t index) const
+{
+    return !buffers[index].queued || twiDone(buffers[index].ticket);
+}
+
+bool PageDisplay::canDraw() const
+{
+    return bufferFree(drawing);
+}
+
+void PageDisplay::beginPage(uint8_t drawPage)
+{
+    page = drawPage;
+    pageTop = drawPage * PAGE_HEIGHT;
+
+    buffers[drawing].queued = false;
+    memset(buffer, 0, screenWidth);
+}
+
+void PageDisplay::endPage()
+{
+    PageBuffer& queued = buffers[drawing];
+
+    // Only pages that changed go over I2C
+    if (!displayPageChanged(page, buffer, screenWidth))
+        return;
+
+    // Window the panel RAM to this page, then stream its columns
+    queued.window[0] = SSD1306_PAGEADDR;
+    queued.window[1] = page;
+    queued.window[2] = page;
+    queued.window[3] = SSD1306_COLUMNADDR;
+    queued.window[4] = 0;
+    queued.window[5] = screenWidth - 1;
+
+    twiSubmit(address, CONTROL_COMMANDS, queued.window, sizeof(queued.window));
+    queued.ticket = twiSubmit(address, CONTROL_DATA, buffer, screenWidth);
+    queued.queued = true;
+
+    // Draw the next page in the other buffer while this one goes out
+    drawing = (drawing + 1) % PAGE_DISPLAY_BUFFERS;
+    buffer = buffers[drawing].pixels;
+}
+
+bool PageDisplay::busy() const
+{
+    for (uint8_t i = 0; i < PAGE_DISPLAY_BUFFERS; i++)
+    {
+        if (!bufferFree(i))
+            return true;
+    }
+
+    return false;
+}
+
+void PageDisplay::invalidate()
+{
+    displayInvalidatePages();
+}
+
+bool PageDisplay::sendFailed()
+{
+    uint16_t errors = twiErrorCount();
+
+    if (errors == sendErrors)
+        return false;
+
+    // A page that wasn't acknowledged was still taken as sent, and would
+    // stay stale until its content changed
+    sendErrors = errors;
+    invalidate();
+
+    return true;
+}
+
+void PageDisplay::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+    fillRect(x, y, 1, 1, color);
+}
+
+void PageDisplay::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+    fillRect(x, y, w, 1, color);
+}
+
+void PageDisplay::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+    fillRect(x, y, 1, h, color);
+}
+
+void PageDisplay::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+    // Straight lines are just thin rectangles
+    if (x0 == x1)
+    {
+        drawFastVLine(x0, min(y0, y1), abs(y1 - y0) + 1, color);
+        return;
+    }
+
+    if (y0 == y1)
+    {
+        drawFastHLine(min(x0, x1), y0, abs(x1 - x0) + 1, color);
+        return;
+    }
+
+    // Skip lines that are entirely above or below this page
+    if ((y0 < pageTop && y1 < pageTop) || (y0 >= pageTop + PAGE_HEIGHT && y1 >= pageTop + PAGE_HEIGHT))
+        return;
+
+    int16_t dx = abs(x1 - x0);
+    int16_t dy = -abs(y1 - y0);
+    int8_t sx = (x0 < x1) ? 1 : -1;
+    int8_t sy = (y0 < y1) ? 1 : -1;
+    int16_t error = dx + dy;
+
+    while (true)
+    {
+        drawPixel(x0, y0, color);
+
+        if (x0 == x1 && y0 == y1)
+            break;
+
+        int16_t twice = 2 * error;
+        if (twice >= dy)
+        {
+            error += dy;
+            x0 += sx;
+        }
+        if (twice <= dx)
+        {
+            error += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void PageDisplay::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+}
+
+void PageDisplay::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    // Clip to the page being drawn, the rest is drawn on other passes
+    int16_t top = max(y, pageTop);
+    int16_t bottom = min(static_cast<int16_t>(y + h), static_cast<int16_t>(pageTop + PAGE_HEIGHT));
+    int16_t left = max(x, static_cast<int16_t>(0));
+    int16_t right = min(static_cast<int16_t>(x + w), static_cast<int16_t>(screenWidth));
+
+    if (top >= bottom || left >= right)
+        return;
+
+    // The rows covered, as bits of each column byte
+    uint8_t bits = static_cast<uint8_t>((0xFF << (top - pageTop)) & (0xFF >> (pageTop + PAGE_HEIGHT - bottom)));
+    uint8_t* column = buffer + left;
+    uint8_t* end = buffer + right;
+
+    if (color == SSD1306_WHITE)
+    {
+        while (column < end)
+            *column++ |= bits;
+    }
+    else if (color == SSD1306_BLACK)
+    {
+        while (column < end)
+            *column++ &= ~bits;
+    }
+    else
+    {
+        while (column < end)
+            *column++ ^= bits;
+    }
+}
+
+void PageDisplay::fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color)
+{
+    fillRect(x, y + r, w, h - 2 * r, color);
+
+    // Rows within r of the top and bottom are inset to round the corners
+    for (int16_t row = 0; row < r; row++)
+    {
+        int16_t rise = r - row;
+        int16_t reach = 0;
+
+        while ((reach + 1) * (reach + 1) <= r * r - rise * rise)
+            reach++;
+
+        int16_t inset = r - reach;
+
+        fillRect(x + inset, y + row, w - 2 * inset, 1, color);
+        fillRect(x + inset, y + h - 1 - row, w - 2 * inset, 1, color);
+    }
+}
+
+void PageDisplay::drawPageBitmap(int16_t x, uint8_t topPage, const uint8_t* bitmap, uint8_t width, uint8_t pages)
+{
+    if (!drawingPages(topPage, pages))
+        return;
+
+    // The row of the bitmap that lands on this page
+    const uint8_t* source = bitmap + (page - topPage) * width;
+
+    for (uint8_t column = 0; column < width; column++, x++)
+    {
+        if (x >= 0 && x < screenWidth)
+            buffer[x] |= pgm_read_byte(source + column);
+    }
+}
+
+void PageDisplay::drawChar(char c)
+{
+    const int16_t size = textSize;
+
+    // Most characters are nowhere near the page being drawn
+    if (cursorY + FONT_CELL_HEIGHT * size > pageTop && cursorY < pageTop + PAGE_HEIGHT)
+    {
+        const uint8_t* glyph = findGlyph(c);
+
+        for (uint8_t column = 0; column < FONT_WIDTH; column++)
+        {
+            uint8_t bits = pgm_read_byte(glyph + column);
+
+            for (uint8_t row = 0; bits; row++, bits >>= 1)
+            {
+                if (bits & 0x01)
+                    fillRect(cursorX + column * size, cursorY + row * size, size, size, textColor);
+            }
+        }
+    }
+
+    cursorX += FONT_CELL_WIDTH * size;
+}
+
+void PageDisplay::print(const char* text)
+{
+    while (*text)
+        drawChar(*text++);
+}
+
+void PageDisplay::print(int value)
+{
+    char text[7];
+    print(itoa(value, text, 10));
+}
+
+void PageDisplay::printProgmem(const char* text)
+{
+    char c;
+
+    while ((c = static_cast<char>(pgm_read_byte(text++))) != 0)
+        drawChar(c);
+}
+
+int16_t PageDisplay::textWidth(const char* text) const
+{
+    return static_cast<int16_t>(strlen(text) * FONT_CELL_WIDTH * textSize);
+}
+
+int16_t PageDisplay::textHeight() const
+{
+    return FONT_CELL_HEIGHT * textSize;
+}
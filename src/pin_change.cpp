@@ -0,0 +1,15 @@
+#include <Arduino.h>
+
+#include "button.h"
+#include "dht11.h"
+#include "power.h"
+
+// Pins 0-7 share one pin change vector, hand it to every module that uses
+// it. The DHT11 and button handlers keep their pin's last level and ignore
+// edges on the others, any edge wakes the MCU from power down.
+ISR(PCINT2_vect)
+{
+    dhtPinChanged();
+    buttonPinChanged();
+    powerPinChanged();
+}
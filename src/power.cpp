@@ -0,0 +1,250 @@
+#include "power.h"
+
+#include <LowPower.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+#include <util/atomic.h>
+
+#include "button.h"
+#include "scheduler.h"
+
+// Pins that wake the MCU from power down: the encoder on D2/D3 and the
+// serial RX line on D0. The byte that wakes the MCU over serial is lost, send
+// it again once awake. The push button on D4 is kept armed by button.cpp.
+#define POWER_WAKE_PINS (_BV(PCINT16) | _BV(PCINT18) | _BV(PCINT19))
+
+// Never sleep longer than the longest watchdog period
+#define POWER_MAX_SLEEP_MILLIS 8000
+
+// Below the shortest watchdog period it's not worth powering down
+#define POWER_MIN_DEEP_MILLIS 15
+
+// Each Timer0 overflow is 1024us, micros() is built from the overflow count
+#define POWER_MICROS_PER_OVERFLOW 1024
+
+// Arduino's millis()/micros() state, advanced by hand after power down
+extern volatile unsigned long timer0_millis;
+extern volatile unsigned long timer0_overflow_count;
+
+static void (*powerInputChanged)() = nullptr;
+
+static unsigned long powerWakeMillis = POWER_MAX_SLEEP_MILLIS;
+static bool powerClocked = false;
+
+static volatile bool powerSleeping = false;
+static volatile bool powerWokenByPin = false;
+
+static unsigned long powerAwakeStart = 0;
+static unsigned long powerAwakeMillis = 0;
+static unsigned long powerAsleepMillis = 0;
+static unsigned int powerAwakeRemainder = 0;
+static unsigned int powerAdcMicros = 0;
+
+static void powerAddAwake(unsigned long micros)
+{
+    // Keep sub-millisecond remainders so short passes still add up
+    micros += powerAwakeRemainder;
+    powerAwakeMillis += micros / 1000;
+    powerAwakeRemainder = micros % 1000;
+}
+
+static period_t powerPeriod(unsigned long millis, unsigned int& periodMillis)
+{
+    // Pick the longest watchdog period that doesn't overshoot the wake time
+    if (millis >= 8000) { periodMillis = 8000; return SLEEP_8S; }
+    if (millis >= 4000) { periodMillis = 4000; return SLEEP_4S; }
+    if (millis >= 2000) { periodMillis = 2000; return SLEEP_2S; }
+    if (millis >= 1000) { periodMillis = 1000; return SLEEP_1S; }
+    if (millis >= 500) { periodMillis = 500; return SLEEP_500MS; }
+    if (millis >= 250) { periodMillis = 250; return SLEEP_250MS; }
+    if (millis >= 120) { periodMillis = 120; return SLEEP_120MS; }
+    if (millis >= 60) { periodMillis = 60; return SLEEP_60MS; }
+    if (millis >= 30) { periodMillis = 30; return SLEEP_30MS; }
+
+    periodMillis = 15;
+    return SLEEP_15MS;
+}
+
+static void powerAdvanceClock(unsigned long millis)
+{
+    // Timer0 is stopped in power down, so credit the time slept to the
+    // counters millis() and micros() read.
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        timer0_millis += millis;
+        timer0_overflow_count += (millis * 1000UL) / POWER_MICROS_PER_OVERFLOW;
+    }
+}
+
+static bool powerSerialBusy()
+{
+    // The UART stops in power down, let it finish sending first
+    return Serial.availableForWrite() < SERIAL_TX_BUFFER_SIZE - 1;
+}
+
+static void powerIdle()
+{
+    // Every clock keeps running, the next interrupt (at worst the 1ms
+    // Timer0 tick) wakes us up again. The ADC stays on for a solar block.
+    unsigned long start = micros();
+
+    LowPower.idle(SLEEP_FOREVER, ADC_ON, TIMER2_ON, TIMER1_ON, TIMER0_ON, SPI_OFF, USART0_ON, TWI_ON);
+
+    powerAsleepMillis += (micros() - start) / 1000;
+}
+
+static void powerDown(unsigned long millis)
+{
+    unsigned int periodMillis;
+    period_t period = powerPeriod(millis, periodMillis);
+
+    powerWokenByPin = false;
+    powerSleeping = true;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        PCIFR = _BV(PCIF2);
+        PCMSK2 |= POWER_WAKE_PINS;
+    }
+
+    // The watchdog interrupt ends the sleep, the handler in LowPower turns
+    // it off again. The ADC would draw current all the while.
+    uint8_t adc = ADCSRA;
+    ADCSRA &= ~_BV(ADEN);
+
+    wdt_enable(period);
+    WDTCSR |= _BV(WDIE);
+
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+
+    // An input or trigger that came in since loop() looked counts as a
+    // wake up already, as does a button edge that armed the debounce:
+    // Timer2 stops in power down and the press would never be read.
+    // Interrupts stay off from the check to the sleep, and the instruction
+    // after sei() always runs, so one that comes in between wakes us
+    // straight back up instead of waiting out the period.
+    cli();
+    bool slept = !powerWokenByPin && !schedulerTriggered() && !buttonBusy();
+    if (slept)
+    {
+        sleep_enable();
+        sleep_bod_disable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+    }
+    sei();
+
+    wdt_disable();
+    ADCSRA = adc;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        PCMSK2 &= ~POWER_WAKE_PINS;
+    }
+
+    powerSleeping = false;
+
+    // A pin wakes us at some unknown point in the period. Credit nothing
+    // rather than a guess, millis() just falls behind and the scheduler
+    // works from wherever it is.
+    unsigned long sleptMillis = (slept && !powerWokenByPin) ? periodMillis : 0;
+
+    powerAdvanceClock(sleptMillis);
+    powerAsleepMillis += sleptMillis;
+}
+
+void powerBegin(void (*inputChanged)())
+{
+    powerInputChanged = inputChanged;
+
+    // The wake pins are only unmasked while powered down
+    PCICR |= _BV(PCIE2);
+
+    powerResetStats();
+}
+
+void powerWakeWithin(unsigned long millisFromNow)
+{
+    if (millisFromNow < powerWakeMillis)
+        powerWakeMillis = millisFromNow;
+}
+
+void powerKeepClocked()
+{
+    powerClocked = true;
+}
+
+void powerSleep()
+{
+    unsigned long sleepMillis = powerWakeMillis;
+    bool clocked = powerClocked || powerSerialBusy();
+
+    powerWakeMillis = POWER_MAX_SLEEP_MILLIS;
+    powerClocked = false;
+
+    if (sleepMillis == 0)
+        return;
+
+    powerAddAwake(micros() - powerAwakeStart);
+
+    if (clocked || sleepMillis < POWER_MIN_DEEP_MILLIS)
+        powerIdle();
+    else
+        powerDown(sleepMillis);
+
+    powerAwakeStart = micros();
+}
+
+void powerSleepForAdc(unsigned int conversionMicros)
+{
+    set_sleep_mode(SLEEP_MODE_ADC);
+    sleep_enable();
+    sleep_cpu();
+    sleep_disable();
+
+    // Any other interrupt ends the sleep early. The conversion carries on
+    // and the next sleep waits out the rest, so only credit it once, when
+    // it has finished.
+    if (ADCSRA & _BV(ADSC))
+        return;
+
+    // Credit the stopped Timer0 in whole milliseconds, keeping the rest
+    powerAdcMicros += conversionMicros;
+
+    if (powerAdcMicros >= 1000)
+    {
+        powerAdvanceClock(powerAdcMicros / 1000);
+        powerAdcMicros %= 1000;
+    }
+}
+
+uint8_t powerAwakePercent()
+{
+    unsigned long total = powerAwakeMillis + powerAsleepMillis;
+
+    if (total < 100)
+        return 100;
+
+    // Scale the total down rather than the awake time up, so this can't overflow
+    return static_cast<uint8_t>(min(powerAwakeMillis / (total / 100), 100UL));
+}
+
+void powerResetStats()
+{
+    powerAwakeMillis = 0;
+    powerAsleepMillis = 0;
+    powerAwakeRemainder = 0;
+    powerAwakeStart = micros();
+}
+
+void powerPinChanged()
+{
+    if (!powerSleeping)
+        return;
+
+    powerWokenByPin = true;
+
+    if (powerInputChanged != nullptr)
+        powerInputChanged();
+}
@@ -0,0 +1,59 @@
+#include "profiler.h"
+
+#ifdef PROFILE_STAGES
+
+static StageStats stages[PROFILE_STAGE_COUNT];
+
+// Short names for the serial dump, in stage order
+static const char* const stageNames[PROFILE_STAGE_COUNT] =
+{
+    "edit", "encoder", "dht", "solar", "render", "flush", "fans"
+};
+
+void profilerRecord(uint8_t stage, uint32_t cycles)
+{
+    StageStats& stats = stages[stage];
+
+    if (stats.count == 0 || cycles < stats.minCycles)
+        stats.minCycles = cycles;
+    if (cycles > stats.maxCycles)
+        stats.maxCycles = cycles;
+
+    // Keep the average meaningful instead of wrapping
+    if (stats.totalCycles + cycles < stats.totalCycles || stats.count == 0xFFFF)
+    {
+        stats.totalCycles /= 2;
+        stats.count /= 2;
+    }
+
+    stats.totalCycles += cycles;
+    stats.count++;
+}
+
+const StageStats& profilerStats(uint8_t stage)
+{
+    return stages[stage];
+}
+
+uint32_t profilerAverageCycles(uint8_t stage)
+{
+    const StageStats& stats = stages[stage];
+
+    if (stats.count == 0)
+        return 0;
+
+    return stats.totalCycles / stats.count;
+}
+
+const char* profilerStageName(uint8_t stage)
+{
+    return stageNames[stage];
+}
+
+void profilerReset()
+{
+    for (uint8_t stage = 0; stage < PROFILE_STAGE_COUNT; stage++)
+        stages[stage] = StageStats();
+}
+
+#endif
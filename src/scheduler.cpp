@@ -0,0 +1,212 @@
+#include "scheduler.h"
+
+#include <util/atomic.h>
+
+struct Task
+{
+    TaskFunction function;
+    uint16_t periodMillis;
+    unsigned long dueMillis;    // Next periodic run
+    unsigned long retryMillis;  // Extra run requested by schedulerDelay()
+    bool retryPending;
+    TaskStats stats;
+};
+
+static Task tasks[SCHEDULER_MAX_TASKS];
+static uint8_t taskCount = 0;
+
+// Tasks triggered from interrupts, one bit per task
+static volatile uint16_t triggeredTasks = 0;
+
+// Passes that ran a task, counted from the millisecond they started in
+static unsigned long passMillis = 0;
+static uint8_t passesAtMillis = 0;
+
+static unsigned long busyMicros = 0;
+static unsigned long statsStartMicros = 0;
+
+static_assert(SCHEDULER_MAX_TASKS <= 16, "triggeredTasks has one bit per task");
+
+static void runTask(uint8_t id, unsigned long now)
+{
+    Task& task = tasks[id];
+
+    task.retryPending = false;
+
+    // A triggered or retried task that isn't due yet is an extra run, so
+    // its periodic schedule stays anchored where it was.
+    if (timeReached(now, task.dueMillis))
+    {
+        // How late did we get to it
+        unsigned long late = now - task.dueMillis;
+        if (late > task.stats.maxLateMillis)
+            task.stats.maxLateMillis = static_cast<uint16_t>(min(late, 0xFFFFUL));
+
+        // Step the deadline by whole periods so the rate stays fixed, unless
+        // a full period was missed, then start over from now.
+        if (late >= task.periodMillis)
+        {
+            task.stats.overruns++;
+            task.dueMillis = now + task.periodMillis;
+        }
+        else
+            task.dueMillis += task.periodMillis;
+    }
+
+    unsigned long start = micros();
+    task.function();
+    unsigned long elapsed = micros() - start;
+
+    busyMicros += elapsed;
+    task.stats.runs++;
+
+    if (elapsed > task.stats.maxRunMicros)
+        task.stats.maxRunMicros = static_cast<uint16_t>(min(elapsed, 0xFFFFUL));
+}
+
+uint8_t schedulerAdd(TaskFunction function, uint16_t periodMillis)
+{
+    if (taskCount >= SCHEDULER_MAX_TASKS)
+        return SCHEDULER_NO_TASK;
+
+    Task& task = tasks[taskCount];
+    task.function = function;
+    task.periodMillis = periodMillis;
+    task.dueMillis = millis();
+    task.retryPending = false;
+    task.stats = TaskStats();
+
+    return taskCount++;
+}
+
+void schedulerRunDue()
+{
+    uint16_t triggered;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        triggered = triggeredTasks;
+        triggeredTasks = 0;
+    }
+
+    unsigned long start = millis();
+    bool ran = false;
+
+    if (start != passMillis)
+    {
+        passMillis = start;
+        passesAtMillis = 0;
+    }
+
+    for (uint8_t id = 0; id < taskCount; id++)
+    {
+        unsigned long now = millis();
+
+        const Task& task = tasks[id];
+
+        if ((triggered & (1U << id)) || timeReached(now, task.dueMillis) ||
+            (task.retryPending && timeReached(now, task.retryMillis)))
+        {
+            runTask(id, now);
+            ran = true;
+        }
+    }
+
+    if (ran && passesAtMillis < 0xFF)
+        passesAtMillis++;
+}
+
+void schedulerTrigger(uint8_t task)
+{
+    if (task >= taskCount)
+        return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        triggeredTasks |= (1U << task);
+    }
+}
+
+bool schedulerTriggered()
+{
+    // Two bytes, but the caller has interrupts off
+    return triggeredTasks != 0;
+}
+
+void schedulerDelay(uint8_t task, uint16_t delayMillis)
+{
+    if (task >= taskCount)
+        return;
+
+    tasks[task].retryMillis = millis() + delayMillis;
+    tasks[task].retryPending = true;
+}
+
+uint8_t schedulerPassesThisMillis()
+{
+    return (millis() == passMillis) ? passesAtMillis : 0;
+}
+
+unsigned long schedulerMillisUntilNext()
+{
+    // Two bytes, read them together so an interrupt can't slip between
+    uint16_t triggered;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        triggered = triggeredTasks;
+    }
+
+    if (triggered)
+        return 0;
+
+    unsigned long now = millis();
+    unsigned long next = 0xFFFFFFFFUL;
+
+    for (uint8_t id = 0; id < taskCount; id++)
+    {
+        const Task& task = tasks[id];
+        unsigned long deadline = task.dueMillis;
+
+        if (task.retryPending && !timeReached(task.retryMillis, deadline))
+            deadline = task.retryMillis;
+
+        if (timeReached(now, deadline))
+            return 0;
+
+        unsigned long wait = deadline - now;
+        if (wait < next)
+            next = wait;
+    }
+
+    return next;
+}
+
+const TaskStats& schedulerStats(uint8_t task)
+{
+    return tasks[task].stats;
+}
+
+uint8_t schedulerTaskCount()
+{
+    return taskCount;
+}
+
+uint8_t schedulerLoadPercent()
+{
+    unsigned long elapsed = micros() - statsStartMicros;
+
+    if (elapsed < 100)
+        return 0;
+
+    return static_cast<uint8_t>(min(busyMicros / (elapsed / 100), 100UL));
+}
+
+void schedulerResetStats()
+{
+    for (uint8_t id = 0; id < taskCount; id++)
+        tasks[id].stats = TaskStats();
+
+    busyMicros = 0;
+    statsStartMicros = micros();
+}
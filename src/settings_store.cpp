@@ -0,0 +1,176 @@
+#include "settings_store.h"
+
+#include <EEPROM.h>
+
+#ifdef __AVR__
+#include <avr/eeprom.h>
+#endif
+
+#include "crc.h"
+
+// Records are appended round-robin over the start of the EEPROM so each
+// save lands on different cells. The rest is left free for other uses.
+// Longer records with more fans get fewer slots.
+#define SETTINGS_STORE_START 0
+#define SETTINGS_STORE_BYTES 384
+#define SETTINGS_STORE_SLOTS (SETTINGS_STORE_BYTES / RECORD_SIZE)
+
+// Bumped whenever the Settings layout changes, older records are ignored.
+// The fan count is part of the layout, four fans is the original.
+#define SETTINGS_VERSION (0xA1 + FAN_COUNT - 4)
+
+// Record layout: version, sequence (2 bytes), settings, CRC-8 of the rest
+#define RECORD_VERSION 0
+#define RECORD_SEQUENCE 1
+#define RECORD_PAYLOAD 3
+#define RECORD_CRC static_cast<uint8_t>(RECORD_PAYLOAD + sizeof(Settings))
+#define RECORD_SIZE (RECORD_CRC + 1)
+
+#define SETTINGS_STORE_END (SETTINGS_STORE_START + SETTINGS_STORE_SLOTS * RECORD_SIZE)
+
+static_assert(SETTINGS_STORE_END <= 512, "Settings store must leave the upper EEPROM free");
+
+static Settings storedSettings;
+static bool storedValid = false;
+static uint8_t newestSlot = SETTINGS_STORE_SLOTS - 1;
+static uint16_t newestSequence = 0;
+
+// The record being written, byte by byte
+static uint8_t pendingRecord[RECORD_SIZE];
+static uint8_t pendingSlot = 0;
+static int8_t pendingStep = -1;
+static uint16_t recordsWritten = 0;
+
+static int slotAddress(uint8_t slot)
+{
+    return SETTINGS_STORE_START + slot * RECORD_SIZE;
+}
+
+static bool readRecord(uint8_t slot, uint8_t record[RECORD_SIZE])
+{
+    int address = slotAddress(slot);
+    uint8_t crc = 0;
+
+    for (uint8_t i = 0; i < RECORD_SIZE; i++)
+    {
+        record[i] = EEPROM.read(address + i);
+
+        if (i < RECORD_CRC)
+            crc = crc8Update(crc, record[i]);
+    }
+
+    return record[RECORD_VERSION] == SETTINGS_VERSION && record[RECORD_CRC] == crc;
+}
+
+static uint16_t recordSequence(const uint8_t record[RECORD_SIZE])
+{
+    return record[RECORD_SEQUENCE] | (static_cast<uint16_t>(record[RECORD_SEQUENCE + 1]) << 8);
+}
+
+static bool eepromReady()
+{
+#ifdef __AVR__
+    return eeprom_is_ready();
+#else
+    return true;
+#endif
+}
+
+bool settingsLoad(Settings& settings)
+{
+    uint8_t record[RECORD_SIZE];
+
+    storedValid = false;
+
+    for (uint8_t slot = 0; slot < SETTINGS_STORE_SLOTS; slot++)
+    {
+        if (!readRecord(slot, record))
+            continue;
+
+        uint16_t sequence = recordSequence(record);
+
+        // Sequence numbers wrap, newer means ahead by less than half the range
+        if (storedValid && static_cast<int16_t>(sequence - newestSequence) <= 0)
+            continue;
+
+        memcpy(&storedSettings, record + RECORD_PAYLOAD, sizeof(Settings));
+        newestSlot = slot;
+        newestSequence = sequence;
+        storedValid = true;
+    }
+
+    if (storedValid)
+        settings = storedSettings;
+
+    return storedValid;
+}
+
+bool settingsSave(const Settings& settings)
+{
+    // Nothing changed, save the EEPROM the wear. A record still being
+    // written is abandoned, its slot stays invalid until it's reused.
+    if (storedValid && memcmp(&settings, &storedSettings, sizeof(Settings)) == 0)
+    {
+        pendingStep = -1;
+        return false;
+    }
+
+    // A record still being written is simply restarted with the new values
+    if (pendingStep < 0)
+    {
+        pendingSlot = (newestSlot + 1 >= SETTINGS_STORE_SLOTS) ? 0 : newestSlot + 1;
+        newestSequence++;
+    }
+
+    pendingRecord[RECORD_VERSION] = SETTINGS_VERSION;
+    pendingRecord[RECORD_SEQUENCE] = static_cast<uint8_t>(newestSequence);
+    pendingRecord[RECORD_SEQUENCE + 1] = static_cast<uint8_t>(newestSequence >> 8);
+    memcpy(pendingRecord + RECORD_PAYLOAD, &settings, sizeof(Settings));
+
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < RECORD_CRC; i++)
+        crc = crc8Update(crc, pendingRecord[i]);
+    pendingRecord[RECORD_CRC] = crc;
+
+    pendingStep = 0;
+
+    return true;
+}
+
+bool settingsUpdate()
+{
+    if (pendingStep < 0)
+        return false;
+
+    // Let the previous byte finish rather than wait for it
+    if (!eepromReady())
+        return true;
+
+    int address = slotAddress(pendingSlot);
+
+    // Clear the version byte first and set it last, so a record cut short
+    // by a power loss never looks valid. Everything in between is written
+    // in order, skipping bytes that already match.
+    if (pendingStep == 0)
+        EEPROM.update(address + RECORD_VERSION, 0);
+    else if (pendingStep < RECORD_SIZE)
+        EEPROM.update(address + pendingStep, pendingRecord[pendingStep]);
+    else
+        EEPROM.update(address + RECORD_VERSION, SETTINGS_VERSION);
+
+    if (++pendingStep <= RECORD_SIZE)
+        return true;
+
+    memcpy(&storedSettings, pendingRecord + RECORD_PAYLOAD, sizeof(Settings));
+    storedValid = true;
+    newestSlot = pendingSlot;
+    pendingStep = -1;
+    recordsWritten++;
+
+    return false;
+}
+
+uint16_t settingsWriteCount()
+{
+    return recordsWritten;
+}
@@ -0,0 +1,91 @@
+#include "solar_adc.h"
+
+#include <util/atomic.h>
+
+#include "power.h"
+
+#define SOLAR_ADC_CHANNEL 0
+#define SOLAR_ADC_EXTRA_BITS 2
+
+// A conversion is 13 ADC clocks at 125kHz
+#define SOLAR_ADC_CONVERSION_MICROS 104
+
+// ADC clock of 16MHz / 128, inside the 50-200kHz needed for full accuracy
+#define SOLAR_ADC_PRESCALER (_BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0))
+
+static_assert(SOLAR_ADC_SAMPLES == 1 << (2 * SOLAR_ADC_EXTRA_BITS), "Each extra bit takes four times the samples");
+
+static volatile uint16_t sum = 0;
+static volatile uint8_t count = 0;
+static volatile uint16_t result = 0;
+static volatile bool sampling = false;
+static volatile bool ready = false;
+
+ISR(ADC_vect)
+{
+    // Sum a block, then decimate it to the extra bits it's worth
+    sum += ADC;
+
+    if (++count < SOLAR_ADC_SAMPLES)
+        return;
+
+    // Stop triggering until the next block is wanted
+    ADCSRA &= ~_BV(ADATE);
+
+    result = sum >> SOLAR_ADC_EXTRA_BITS;
+    sampling = false;
+    ready = true;
+}
+
+void solarAdcBegin()
+{
+    // AVcc reference, and no digital input buffer wasting power on the pin
+    ADMUX = _BV(REFS0) | SOLAR_ADC_CHANNEL;
+    DIDR0 |= _BV(ADC0D);
+
+    // Timer0 overflow as the trigger, which the millis() interrupt clears
+    // again each time. It's only armed while a block is sampled.
+    ADCSRB = _BV(ADTS2);
+    ADCSRA = _BV(ADEN) | _BV(ADIE) | SOLAR_ADC_PRESCALER;
+}
+
+void solarAdcStart()
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        sum = 0;
+        count = 0;
+        sampling = true;
+        ready = false;
+
+#ifndef SOLAR_ADC_NOISE_REDUCTION
+        ADCSRA |= _BV(ADATE);
+#endif
+    }
+
+#ifdef SOLAR_ADC_NOISE_REDUCTION
+    // Entering the sleep mode starts each conversion, the other clocks are
+    // quiet until it's done.
+    while (sampling)
+        powerSleepForAdc(SOLAR_ADC_CONVERSION_MICROS);
+#endif
+}
+
+bool solarAdcBusy()
+{
+    return sampling;
+}
+
+bool solarAdcRead(uint16_t& value)
+{
+    bool fresh;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        value = result;
+        fresh = ready;
+        ready = false;
+    }
+
+    return fresh;
+}
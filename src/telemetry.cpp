@@ -0,0 +1,73 @@
+#include "telemetry.h"
+
+#include "crc.h"
+#include "spsc_queue.h"
+
+// Room for several status frames, so a slow UART drops frames rather than
+// holding up loop()
+#define TELEMETRY_RING_SIZE 128
+
+static SpscQueue<uint8_t, TELEMETRY_RING_SIZE> ring;
+static uint16_t sequence = 0;
+static uint16_t dropped = 0;
+
+static void queueByte(uint8_t value, uint16_t& crc)
+{
+    ring.push(value);
+    crc = crc16Update(crc, value);
+}
+
+bool telemetrySend(uint8_t type, const void* payload, uint8_t length)
+{
+    const uint8_t frameSize = TELEMETRY_HEADER_SIZE + length + TELEMETRY_CRC_SIZE;
+
+    if (TELEMETRY_RING_SIZE - ring.size() < frameSize)
+    {
+        dropped++;
+        return false;
+    }
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(payload);
+    uint16_t crc = 0xFFFF;
+
+    ring.push(TELEMETRY_SYNC1);
+    ring.push(TELEMETRY_SYNC2);
+
+    queueByte(type, crc);
+    queueByte(length, crc);
+    queueByte(lowByte(sequence), crc);
+    queueByte(highByte(sequence), crc);
+
+    for (uint8_t i = 0; i < length; i++)
+        queueByte(bytes[i], crc);
+
+    ring.push(lowByte(crc));
+    ring.push(highByte(crc));
+
+    // The decoder counts gaps in the sequence as lost frames
+    sequence++;
+
+    return true;
+}
+
+void telemetryFlush()
+{
+    int room = Serial.availableForWrite();
+    uint8_t value;
+
+    while (room-- > 0 && ring.pop(value))
+        Serial.write(value);
+}
+
+void telemetryDrain()
+{
+    uint8_t value;
+
+    while (ring.pop(value))
+        Serial.write(value);
+}
+
+uint16_t telemetryDroppedCount()
+{
+    return dropped;
+}
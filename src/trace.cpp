@@ -0,0 +1,90 @@
+#include "trace.h"
+
+#ifdef TRACE_RECORD
+
+#include "scheduler.h"
+#include "telemetry.h"
+
+// A frame is a fixed header and an optional tail, both under this
+#define TRACE_MAX_PAYLOAD 32
+
+static_assert(sizeof(TraceBoot) + sizeof(Settings) <= TRACE_MAX_PAYLOAD, "Boot frame too big");
+static_assert(sizeof(TraceFans) + FAN_COUNT <= TRACE_MAX_PAYLOAD, "Fans frame too big");
+
+static void send(uint8_t type, const void* header, uint8_t headerSize, const void* tail = nullptr, uint8_t tailSize = 0)
+{
+    uint8_t payload[TRACE_MAX_PAYLOAD];
+
+    memcpy(payload, header, headerSize);
+
+    if (tail != nullptr)
+        memcpy(payload + headerSize, tail, tailSize);
+
+    // A dropped frame shows up as a gap in the sequence numbers
+    telemetrySend(type, payload, headerSize + tailSize);
+}
+
+void traceBoot(const Settings& settings)
+{
+    TraceBoot boot;
+    boot.millis = millis();
+    boot.fanCount = FAN_COUNT;
+
+    send(TELEMETRY_TRACE_BOOT, &boot, sizeof(boot), &settings, sizeof(settings));
+}
+
+void traceDht(const DhtSample& sample)
+{
+    TraceDht dht;
+    dht.millis = millis();
+    dht.humidity = sample.humidity;
+    dht.temperatureTenths = sample.temperatureTenths;
+
+    send(TELEMETRY_TRACE_DHT, &dht, sizeof(dht));
+}
+
+void traceSolar(uint16_t reading)
+{
+    TraceSolar solar;
+    solar.millis = millis();
+    solar.reading = reading;
+
+    send(TELEMETRY_TRACE_SOLAR, &solar, sizeof(solar));
+}
+
+void traceDetent(int8_t steps)
+{
+    TraceInput input;
+    input.millis = millis();
+    input.steps = steps;
+    input.button = 0;
+    input.pass = schedulerPassesThisMillis();
+
+    send(TELEMETRY_TRACE_INPUT, &input, sizeof(input));
+}
+
+void traceButton(ButtonEvent event)
+{
+    TraceInput input;
+    input.millis = millis();
+    input.steps = 0;
+    input.button = event;
+    input.pass = schedulerPassesThisMillis();
+
+    send(TELEMETRY_TRACE_INPUT, &input, sizeof(input));
+}
+
+void traceFans()
+{
+    TraceFans fans;
+    fans.millis = millis();
+    fans.fanCount = FAN_COUNT;
+
+    uint8_t duty[FAN_COUNT];
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+        duty[fan] = fanOutputDuty(fan);
+
+    send(TELEMETRY_TRACE_FANS, &fans, sizeof(fans), duty, sizeof(duty));
+}
+
+#endif
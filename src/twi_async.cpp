@@ -0,0 +1,146 @@
+#include "twi_async.h"
+
+#include <util/atomic.h>
+#include <util/twi.h>
+
+#include "spsc_queue.h"
+
+#define TWI_SDA_PIN A4
+#define TWI_SCL_PIN A5
+
+struct TwiTransfer
+{
+    uint8_t address;
+    uint8_t control;
+    const uint8_t* data;
+    uint8_t length;
+};
+
+// Filled by loop(), emptied by the interrupt
+static SpscQueue<TwiTransfer, TWI_QUEUE_SIZE> queue;
+
+// The transfer on the bus, only touched by the interrupt once it's started
+static TwiTransfer current;
+static uint8_t sent = 0;
+static volatile bool active = false;
+
+// Tickets are handed out in order and finish in order
+static uint8_t submitted = 0;
+static volatile uint8_t completed = 0;
+static volatile uint16_t errors = 0;
+
+#define TWI_CONTINUE (_BV(TWINT) | _BV(TWEN) | _BV(TWIE))
+
+static void startNext()
+{
+    // Another transfer goes out after a (repeated) start, otherwise let the
+    // bus go
+    if (queue.pop(current))
+    {
+        sent = 0;
+        active = true;
+        TWCR = TWI_CONTINUE | _BV(TWSTA);
+    }
+    else
+    {
+        active = false;
+        TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWSTO);
+    }
+}
+
+static void finishTransfer()
+{
+    completed++;
+    startNext();
+}
+
+ISR(TWI_vect)
+{
+    switch (TW_STATUS)
+    {
+        case TW_START:
+        case TW_REP_START:
+            TWDR = TW_WRITE | (current.address << 1);
+            TWCR = TWI_CONTINUE;
+            break;
+
+        case TW_MT_SLA_ACK:
+            TWDR = current.control;
+            TWCR = TWI_CONTINUE;
+            break;
+
+        case TW_MT_DATA_ACK:
+            if (sent < current.length)
+            {
+                TWDR = current.data[sent++];
+                TWCR = TWI_CONTINUE;
+            }
+            else
+            {
+                finishTransfer();
+            }
+            break;
+
+        default:
+            // Not acknowledged, or the bus was lost; give up on this one
+            errors++;
+            finishTransfer();
+            break;
+    }
+}
+
+void twiBegin()
+{
+    // The internal pull-ups help, the panel module has its own as well
+    digitalWrite(TWI_SDA_PIN, HIGH);
+    digitalWrite(TWI_SCL_PIN, HIGH);
+
+    TWSR = 0;
+    TWBR = ((F_CPU / TWI_CLOCK) - 16) / 2;
+    TWCR = _BV(TWEN);
+}
+
+uint8_t twiSubmit(uint8_t address, uint8_t control, const uint8_t* data, uint8_t length)
+{
+    TwiTransfer transfer = { address, control, data, length };
+
+    // The interrupt makes room as it goes
+    while (!queue.push(transfer))
+        ;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (!active)
+        {
+            // A stop may still be going out from the last transfer
+            while (TWCR & _BV(TWSTO))
+                ;
+
+            startNext();
+        }
+    }
+
+    return submitted++;
+}
+
+bool twiDone(uint8_t ticket)
+{
+    return static_cast<int8_t>(completed - ticket) > 0;
+}
+
+bool twiBusy()
+{
+    return active || !queue.empty();
+}
+
+uint16_t twiErrorCount()
+{
+    uint16_t count;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        count = errors;
+    }
+
+    return count;
+}
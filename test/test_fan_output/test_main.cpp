@@ -0,0 +1,112 @@
+#include <unity.h>
+
+#include "fan_output.h"
+
+// The pin backend's fan to port mapping, against the mock ports:
+// pio test -e native_test
+
+void setUp()
+{
+    fanOutputBegin();
+}
+
+void tearDown()
+{
+}
+
+static void applyFull(uint8_t mask)
+{
+    uint8_t duty[FAN_COUNT];
+
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+        duty[fan] = (mask & (1 << fan)) ? FAN_DUTY_MAX : 0;
+
+    fanOutputApply(duty);
+}
+
+static void test_begins_off()
+{
+    TEST_ASSERT_EQUAL_HEX8(0, fanMockPortB());
+    TEST_ASSERT_EQUAL_HEX8(0, fanMockPortD());
+    TEST_ASSERT_EQUAL(0, fanOutputMask());
+}
+
+static void test_each_fan_drives_its_pin()
+{
+    // Fan 1 is D6 (PD6), fan 2 D5 (PD5), fan 3 D10 (PB2) and fan 4 D9 (PB1)
+    applyFull(0x01);
+    TEST_ASSERT_EQUAL_HEX8(_BV(6), fanMockPortD());
+    TEST_ASSERT_EQUAL_HEX8(0, fanMockPortB());
+
+    applyFull(0x02);
+    TEST_ASSERT_EQUAL_HEX8(_BV(5), fanMockPortD());
+    TEST_ASSERT_EQUAL_HEX8(0, fanMockPortB());
+
+    applyFull(0x04);
+    TEST_ASSERT_EQUAL_HEX8(0, fanMockPortD());
+    TEST_ASSERT_EQUAL_HEX8(_BV(2), fanMockPortB());
+
+    applyFull(0x08);
+    TEST_ASSERT_EQUAL_HEX8(0, fanMockPortD());
+    TEST_ASSERT_EQUAL_HEX8(_BV(1), fanMockPortB());
+}
+
+static void test_every_mask_maps_onto_the_ports()
+{
+    for (uint8_t mask = 0; mask <= FAN_ALL; mask++)
+    {
+        applyFull(mask);
+
+        uint8_t portD = ((mask & 0x01) ? _BV(6) : 0) | ((mask & 0x02) ? _BV(5) : 0);
+        uint8_t portB = ((mask & 0x04) ? _BV(2) : 0) | ((mask & 0x08) ? _BV(1) : 0);
+
+        TEST_ASSERT_EQUAL_HEX8(portD, fanMockPortD());
+        TEST_ASSERT_EQUAL_HEX8(portB, fanMockPortB());
+        TEST_ASSERT_EQUAL(mask, fanOutputMask());
+    }
+}
+
+static void test_only_the_changed_port_is_written()
+{
+    applyFull(0x01);
+    uint16_t writes = fanOutputWriteCount();
+
+    // Fan 2 shares PORTD with fan 1, PORTB is left alone
+    applyFull(0x03);
+    TEST_ASSERT_EQUAL(writes + 1, fanOutputWriteCount());
+
+    // Nothing changed, nothing written
+    applyFull(0x03);
+    TEST_ASSERT_EQUAL(writes + 1, fanOutputWriteCount());
+}
+
+static void test_part_duty_leaves_the_port_bit_to_the_timer()
+{
+    uint8_t duty[FAN_COUNT] = { 128, FAN_DUTY_MAX, 0, 0 };
+    fanOutputApply(duty);
+
+    TEST_ASSERT_EQUAL_HEX8(_BV(5), fanMockPortD());
+    TEST_ASSERT_EQUAL(0x03, fanOutputMask());
+    TEST_ASSERT_TRUE(fanOutputPwmActive());
+    TEST_ASSERT_EQUAL(128, fanOutputDuty(0));
+
+    // Back to full speed, the port takes over from the timer
+    duty[0] = FAN_DUTY_MAX;
+    fanOutputApply(duty);
+
+    TEST_ASSERT_EQUAL_HEX8(_BV(6) | _BV(5), fanMockPortD());
+    TEST_ASSERT_FALSE(fanOutputPwmActive());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_begins_off);
+    RUN_TEST(test_each_fan_drives_its_pin);
+    RUN_TEST(test_every_mask_maps_onto_the_ports);
+    RUN_TEST(test_only_the_changed_port_is_written);
+    RUN_TEST(test_part_duty_leaves_the_port_bit_to_the_timer);
+
+    return UNITY_END();
+}
@@ -0,0 +1,227 @@
+#include <unity.h>
+
+#include "ring_filter.h"
+
+// RingFilter, MedianFilter and EmaFilter on the host: pio test -e native_test
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_starts_at_zero()
+{
+    RingFilter<uint8_t, 4> filter;
+
+    TEST_ASSERT_EQUAL(0, filter.average());
+
+    for (uint8_t i = 0; i < filter.size(); i++)
+        TEST_ASSERT_EQUAL(0, filter.sample(i));
+}
+
+static void test_fill_sets_every_sample()
+{
+    RingFilter<uint8_t, 4> filter;
+    filter.fill(200);
+
+    TEST_ASSERT_EQUAL(200, filter.average());
+
+    for (uint8_t i = 0; i < filter.size(); i++)
+        TEST_ASSERT_EQUAL(200, filter.sample(i));
+
+    // The sum is rebuilt too, not added to
+    filter.fill(10);
+    TEST_ASSERT_EQUAL(10, filter.average());
+}
+
+static void test_add_replaces_the_oldest()
+{
+    RingFilter<int16_t, 4, int32_t> filter;
+    filter.fill(0);
+
+    TEST_ASSERT_EQUAL(25, filter.add(100));
+    TEST_ASSERT_EQUAL(50, filter.add(100));
+    TEST_ASSERT_EQUAL(75, filter.add(100));
+    TEST_ASSERT_EQUAL(100, filter.add(100));
+
+    // Only the newest four count
+    TEST_ASSERT_EQUAL(100, filter.add(100));
+}
+
+static void test_window_wraps_in_order()
+{
+    RingFilter<int16_t, 4, int32_t> filter;
+
+    // Six samples into four places, 3 to 6 are left, oldest first
+    for (int16_t value = 1; value <= 6; value++)
+        filter.add(value);
+
+    TEST_ASSERT_EQUAL(3, filter.sample(0));
+    TEST_ASSERT_EQUAL(4, filter.sample(1));
+    TEST_ASSERT_EQUAL(5, filter.sample(2));
+    TEST_ASSERT_EQUAL(6, filter.sample(3));
+
+    // The running sum matches the window after many turns round the ring
+    for (int16_t value = 0; value < 1000; value++)
+        filter.add(value);
+
+    TEST_ASSERT_EQUAL((996 + 997 + 998 + 999) / 4, filter.average());
+}
+
+static void test_average_rounds_down()
+{
+    RingFilter<int16_t, 4, int32_t> filter;
+    filter.fill(0);
+
+    // 7 / 4
+    filter.add(7);
+    TEST_ASSERT_EQUAL(1, filter.average());
+
+    // -7 / 4 is a shift too, so towards minus infinity
+    filter.fill(0);
+    filter.add(-7);
+    TEST_ASSERT_EQUAL(-2, filter.average());
+}
+
+static void test_byte_samples_fit_the_default_sum()
+{
+    // 32 bytes at 255 is 8160, the uint16_t sum holds it
+    RingFilter<uint8_t, 32> filter;
+    filter.fill(255);
+
+    TEST_ASSERT_EQUAL(255, filter.average());
+    TEST_ASSERT_EQUAL(247, filter.add(0));
+}
+
+static void test_median_of_an_odd_window()
+{
+    MedianFilter<int16_t, 5> filter;
+    filter.fill(10);
+
+    // Spikes either way don't move it, a run of new readings does
+    TEST_ASSERT_EQUAL(10, filter.add(900));
+    TEST_ASSERT_EQUAL(10, filter.add(-900));
+    TEST_ASSERT_EQUAL(10, filter.add(12));
+    TEST_ASSERT_EQUAL(12, filter.add(13));
+}
+
+static void test_median_follows_the_window_round()
+{
+    MedianFilter<int16_t, 5> filter;
+
+    // 1 to 12 through five places, the median is always the middle of the
+    // newest five once they're in
+    for (int16_t value = 1; value <= 12; value++)
+    {
+        int16_t median = filter.add(value);
+
+        if (value >= 5)
+            TEST_ASSERT_EQUAL(value - 2, median);
+    }
+
+    // Falling back through the same values, duplicates included
+    for (int16_t value = 12; value >= 1; value--)
+        filter.add(value);
+
+    TEST_ASSERT_EQUAL(3, filter.median());
+}
+
+static void test_median_of_an_even_window()
+{
+    MedianFilter<int16_t, 4> filter;
+    filter.fill(0);
+
+    // 0 0 0 7, the middle two are 0 and 0
+    TEST_ASSERT_EQUAL(0, filter.add(7));
+
+    // 0 0 7 9
+    TEST_ASSERT_EQUAL(3, filter.add(9));
+
+    // Round the ring twice more: 7 9 -5 -8 and then -5 -8 -2 -1
+    filter.add(-5);
+    TEST_ASSERT_EQUAL(1, filter.add(-8));
+    filter.add(-2);
+
+    // -2 and -5 mean -3.5, rounded down
+    TEST_ASSERT_EQUAL(-4, filter.add(-1));
+}
+
+static void test_ema_fill_is_exact()
+{
+    EmaFilter<int16_t, 3> filter;
+
+    filter.fill(-123);
+    TEST_ASSERT_EQUAL(-123, filter.average());
+
+    filter.fill(456);
+    TEST_ASSERT_EQUAL(456, filter.average());
+}
+
+static void test_ema_converges_from_either_side()
+{
+    EmaFilter<int16_t, 3> rising;
+    EmaFilter<int16_t, 3> falling;
+    rising.fill(-400);
+    falling.fill(300);
+
+    for (uint8_t i = 0; i < 200; i++)
+    {
+        rising.add(-57);
+        falling.add(-57);
+    }
+
+    TEST_ASSERT_EQUAL(-57, rising.average());
+    TEST_ASSERT_EQUAL(-57, falling.average());
+}
+
+static void test_ema_steps_by_its_factor()
+{
+    EmaFilter<int16_t, 2> filter;
+    filter.fill(0);
+
+    // A quarter of the way each sample: 100 is 25, then 43.75
+    TEST_ASSERT_EQUAL(25, filter.add(100));
+    TEST_ASSERT_EQUAL(43, filter.add(100));
+}
+
+static void test_ema_rounds_down_for_negative_inputs()
+{
+    EmaFilter<int16_t, 2> filter;
+    filter.fill(0);
+
+    // -100 is -25, then -43.75 which rounds down to -44, not towards zero
+    TEST_ASSERT_EQUAL(-25, filter.add(-100));
+    TEST_ASSERT_EQUAL(-44, filter.add(-100));
+
+    // The smallest step down shows straight away, the smallest step up
+    // doesn't
+    filter.fill(0);
+    TEST_ASSERT_EQUAL(-1, filter.add(-1));
+
+    filter.fill(0);
+    TEST_ASSERT_EQUAL(0, filter.add(1));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_starts_at_zero);
+    RUN_TEST(test_fill_sets_every_sample);
+    RUN_TEST(test_add_replaces_the_oldest);
+    RUN_TEST(test_window_wraps_in_order);
+    RUN_TEST(test_average_rounds_down);
+    RUN_TEST(test_byte_samples_fit_the_default_sum);
+    RUN_TEST(test_median_of_an_odd_window);
+    RUN_TEST(test_median_follows_the_window_round);
+    RUN_TEST(test_median_of_an_even_window);
+    RUN_TEST(test_ema_fill_is_exact);
+    RUN_TEST(test_ema_converges_from_either_side);
+    RUN_TEST(test_ema_steps_by_its_factor);
+    RUN_TEST(test_ema_rounds_down_for_negative_inputs);
+
+    return UNITY_END();
+}
@@ -0,0 +1,132 @@
+#include <unity.h>
+
+#include "ring_filter.h"
+
+// TrendFilter on the host, at the size FAN_AUTO uses: pio test -e native_test
+
+#define SAMPLES 32
+
+typedef TrendFilter<int16_t, SAMPLES> Trend;
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_flat_series_has_no_slope()
+{
+    Trend trend;
+    TEST_ASSERT_EQUAL_INT32(0, trend.slope());
+
+    trend.fill(725);
+    TEST_ASSERT_EQUAL_INT32(0, trend.slope());
+    TEST_ASSERT_EQUAL_INT16(0, trend.change(20));
+
+    // The same value added over and over stays flat
+    for (uint8_t i = 0; i < 3 * SAMPLES; i++)
+        trend.add(725);
+
+    TEST_ASSERT_EQUAL_INT32(0, trend.slope());
+}
+
+static void test_linear_rise_is_exact()
+{
+    Trend trend;
+
+    // Ten tenths a sample, 2560 in Q8
+    for (int16_t i = 0; i < SAMPLES; i++)
+        trend.add(700 + 10 * i);
+
+    TEST_ASSERT_EQUAL_INT32(2560, trend.slope());
+    TEST_ASSERT_EQUAL_INT16(200, trend.change(20));
+}
+
+static void test_slope_survives_the_ring_wrapping()
+{
+    Trend trend;
+    trend.fill(0);
+
+    // Many turns of the ring, the running sums have to stay in step
+    for (int16_t i = 0; i < 5 * SAMPLES + 7; i++)
+        trend.add(3 * i);
+
+    TEST_ASSERT_EQUAL_INT32(3 * 256, trend.slope());
+}
+
+static void test_fill_starts_over()
+{
+    Trend trend;
+
+    for (int16_t i = 0; i < SAMPLES; i++)
+        trend.add(10 * i);
+
+    trend.fill(-40);
+    TEST_ASSERT_EQUAL_INT32(0, trend.slope());
+
+    // A single step up at the newest sample is a small rise, not a flat one
+    trend.add(-30);
+    TEST_ASSERT_TRUE(trend.slope() > 0);
+}
+
+static void test_negative_celsius_tenths()
+{
+    Trend trend;
+
+    // -20.0C and falling half a degree a sample
+    for (int16_t i = 0; i < SAMPLES; i++)
+        trend.add(-200 - 5 * i);
+
+    TEST_ASSERT_EQUAL_INT32(-1280, trend.slope());
+    TEST_ASSERT_EQUAL_INT16(-100, trend.change(20));
+}
+
+static void test_rounding_is_towards_zero_either_way()
+{
+    Trend rising;
+    Trend falling;
+
+    // A tenth every three samples is 2640 / 31 = 85.16 in Q8, either side
+    // of zero, around -5.0C
+    for (int16_t i = 0; i < SAMPLES; i++)
+    {
+        rising.add(-50 + i / 3);
+        falling.add(50 - i / 3);
+    }
+
+    TEST_ASSERT_EQUAL_INT32(85, rising.slope());
+    TEST_ASSERT_EQUAL_INT32(-85, falling.slope());
+
+    // 85 * 20 / 256 = 6.6
+    TEST_ASSERT_EQUAL_INT16(6, rising.change(20));
+    TEST_ASSERT_EQUAL_INT16(-6, falling.change(20));
+}
+
+static void test_widest_samples_fit()
+{
+    Trend trend;
+
+    // The header promises 16-bit samples up to N = 32, a rise across most
+    // of that range must not overflow the sums
+    for (int16_t i = 0; i < SAMPLES; i++)
+        trend.add(-32000 + 2000 * i);
+
+    TEST_ASSERT_EQUAL_INT32(2000L * 256, trend.slope());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_flat_series_has_no_slope);
+    RUN_TEST(test_linear_rise_is_exact);
+    RUN_TEST(test_slope_survives_the_ring_wrapping);
+    RUN_TEST(test_fill_starts_over);
+    RUN_TEST(test_negative_celsius_tenths);
+    RUN_TEST(test_rounding_is_towards_zero_either_way);
+    RUN_TEST(test_widest_samples_fit);
+
+    return UNITY_END();
+}
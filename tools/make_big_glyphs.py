@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""Generate include/big_glyphs.h, the 3x glyphs drawn by drawBigText().
+
+Each glyph is the 5x7 font glyph from src/page_display.cpp scaled by three,
+stored a display page at a time so drawing it is a straight byte copy.
+Rerun after changing the font or the character set:
+
+    tools/make_big_glyphs.py
+"""
+
+import os
+import re
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+FONT_SOURCE = os.path.join(ROOT, "src", "page_display.cpp")
+OUTPUT = os.path.join(ROOT, "include", "big_glyphs.h")
+
+# Digits for the values and the letters of the option words
+CHARACTERS = "0123456789AFLNORSTU"
+SCALE = 3
+FONT_WIDTH = 5
+FONT_HEIGHT = 8
+PAGE_HEIGHT = 8
+
+GLYPH_LINE = re.compile(r"\{\s*((?:0x[0-9A-Fa-f]{2},?\s*){5})\}\s*,?\s*//\s*(\S+)")
+
+
+def read_font():
+    glyphs = {}
+    with open(FONT_SOURCE) as source:
+        for line in source:
+            match = GLYPH_LINE.search(line)
+            if match:
+                columns = [int(value, 16) for value in re.findall(r"0x[0-9A-Fa-f]{2}", match.group(1))]
+                name = match.group(2)
+                glyphs[" " if name == "space" else name] = columns
+    return glyphs
+
+
+def scale_glyph(columns):
+    """Return the scaled glyph as PAGES rows of WIDTH bytes."""
+    pages = FONT_HEIGHT * SCALE // PAGE_HEIGHT
+    scaled = []
+
+    for column in columns:
+        bits = 0
+        for row in range(FONT_HEIGHT):
+            if column & (1 << row):
+                bits |= ((1 << SCALE) - 1) << (row * SCALE)
+        scaled += [bits] * SCALE
+
+    return [[(bits >> (page * PAGE_HEIGHT)) & 0xFF for bits in scaled] for page in range(pages)]
+
+
+def main():
+    font = read_font()
+    missing = [c for c in CHARACTERS if c not in font]
+    if missing:
+        raise SystemExit("not in the font: " + "".join(missing))
+
+    width = FONT_WIDTH * SCALE
+    pages = FONT_HEIGHT * SCALE // PAGE_HEIGHT
+
+    lines = [
+        "#ifndef BIG_GLYPHS_H",
+        "#define BIG_GLYPHS_H",
+        "",
+        "// Generated by tools/make_big_glyphs.py from the font in",
+        "// src/page_display.cpp, rerun it rather than editing this file.",
+        "",
+        "#include <Arduino.h>",
+        "",
+        "#define BIG_GLYPH_WIDTH %d" % width,
+        "#define BIG_GLYPH_PAGES %d" % pages,
+        "",
+        "static const char bigGlyphCharacters[] PROGMEM = \"%s\";" % CHARACTERS,
+        "",
+        "// One page of %d columns after another, top page first" % width,
+        "static const uint8_t bigGlyphs[][BIG_GLYPH_PAGES * BIG_GLYPH_WIDTH] PROGMEM =",
+        "{",
+    ]
+
+    for index, character in enumerate(CHARACTERS):
+        rows = scale_glyph(font[character])
+        lines.append("    {   // %s" % character)
+        for page, row in enumerate(rows):
+            separator = "," if page < len(rows) - 1 else ""
+            lines.append("        " + ", ".join("0x%02X" % value for value in row) + separator)
+        lines.append("    }" + ("," if index < len(CHARACTERS) - 1 else ""))
+
+    lines += ["};", "", "#endif", ""]
+
+    with open(OUTPUT, "w") as output:
+        output.write("\n".join(lines))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+"""Decode the GardenFan binary telemetry stream as it arrives.
+
+Reads from a serial port (needs pyserial) or from a file/stdin, prints one
+line per frame and passes any text the firmware prints (replies to the
+'d', 'h', 's', 'f' and 'p' commands) through as-is. Frame layout matches
+include/telemetry.h. Trace frames from -DTRACE_RECORD builds are printed
+too; --save keeps the raw bytes for native/replay.
+
+    tools/telemetry_decode.py /dev/ttyUSB0
+    tools/telemetry_decode.py --csv /dev/ttyUSB0 > log.csv
+    tools/telemetry_decode.py - < capture.bin
+    tools/telemetry_decode.py --save capture.bin /dev/ttyUSB0
+"""
+
+import argparse
+import struct
+import sys
+
+SYNC = b"\xA5\x5A"
+HEADER = struct.Struct("<BBH")  # type, payload length, sequence
+CRC = struct.Struct("<H")
+
+TELEMETRY_STATUS = 0x01
+STATUS = struct.Struct("<hBBBBBHBBBI")
+STATUS_FIELDS = ("temperature", "humidity", "solar", "set_temperature", "set_humidity",
+                 "set_solar", "fans", "power", "flags", "screen", "uptime_ms")
+
+TELEMETRY_TRACE_BOOT = 0x10
+TELEMETRY_TRACE_DHT = 0x11
+TELEMETRY_TRACE_SOLAR = 0x12
+TELEMETRY_TRACE_INPUT = 0x13
+TELEMETRY_TRACE_FANS = 0x14
+TRACE_BOOT = struct.Struct("<IB")       # millis, fan count, then the settings
+TRACE_DHT = struct.Struct("<IBh")       # millis, humidity, Celsius tenths
+TRACE_SOLAR = struct.Struct("<IH")      # millis, 12-bit reading
+TRACE_INPUT = struct.Struct("<IbBB")    # millis, steps, button event, pass
+TRACE_FANS = struct.Struct("<IB")       # millis, fan count, then the duties
+BUTTON_EVENTS = ("press", "long press", "double press")
+
+FLAG_EDIT = 0x01
+FLAG_NO_DISPLAY = 0x02
+POWER_NAMES = ("off", "on", "solar")
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, as crc16Update() in include/crc.h."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+class Decoder:
+    """Splits a byte stream into frames and text, resynchronising on errors."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.text = bytearray()
+        self.last_sequence = None
+        self.frames = 0
+        self.crc_errors = 0
+        self.lost = 0
+
+    def feed(self, data):
+        """Yield ("frame", type, sequence, payload) and ("text", line) items."""
+        self.buffer += data
+
+        while True:
+            start = self.buffer.find(SYNC)
+
+            if start < 0:
+                # Keep a trailing first sync byte, the second may be next
+                keep = 1 if self.buffer.endswith(SYNC[:1]) else 0
+                yield from self._text(self.buffer[:len(self.buffer) - keep])
+                del self.buffer[:len(self.buffer) - keep]
+                return
+
+            yield from self._text(self.buffer[:start])
+            del self.buffer[:start]
+
+            if len(self.buffer) < len(SYNC) + HEADER.size:
+                return
+
+            kind, length, sequence = HEADER.unpack_from(self.buffer, len(SYNC))
+            end = len(SYNC) + HEADER.size + length + CRC.size
+
+            if len(self.buffer) < end:
+                return
+
+            body = bytes(self.buffer[len(SYNC):end - CRC.size])
+            (expected,) = CRC.unpack_from(self.buffer, end - CRC.size)
+
+            if crc16(body) != expected:
+                # Not a frame after all, skip this sync and look again
+                self.crc_errors += 1
+                yield from self._text(self.buffer[:1])
+                del self.buffer[:1]
+                continue
+
+            if self.last_sequence is not None:
+                self.lost += (sequence - self.last_sequence - 1) & 0xFFFF
+            self.last_sequence = sequence
+            self.frames += 1
+
+            del self.buffer[:end]
+            yield ("frame", kind, sequence, body[HEADER.size:])
+
+    def _text(self, data):
+        for byte in data:
+            if byte == 0x0A:
+                line = self.text.decode("ascii", "replace").rstrip("\r")
+                self.text.clear()
+                if line:
+                    yield ("text", line)
+            elif byte == 0x0D or 0x20 <= byte < 0x7F:
+                self.text.append(byte)
+
+
+def decode_status(payload):
+    status = dict(zip(STATUS_FIELDS, STATUS.unpack(payload)))
+    status["temperature"] /= 10.0
+    return status
+
+
+def format_status(sequence, status):
+    # At least the four fans of the default build, more when a higher one runs
+    count = max(4, status["fans"].bit_length())
+    fans = "".join(str((fan + 1) % 10) if status["fans"] & (1 << fan) else "-" for fan in range(count))
+    power = POWER_NAMES[status["power"]] if status["power"] < len(POWER_NAMES) else status["power"]
+    mode = "EDIT" if status["flags"] & FLAG_EDIT else "DISPLAY"
+    if status["flags"] & FLAG_NO_DISPLAY:
+        mode += " NO DISPLAY"
+
+    return ("#%05d %9.1fs  %5.1fF (set %d)  %3d%% RH (set %d)  solar %3d%% (set %d)  "
+            "fans %s  power %s  screen %d %s" % (
+                sequence, status["uptime_ms"] / 1000.0, status["temperature"], status["set_temperature"],
+                status["humidity"], status["set_humidity"], status["solar"], status["set_solar"],
+                fans, power, status["screen"], mode))
+
+
+def format_trace(sequence, kind, payload):
+    """One line for a trace frame, or None if it isn't one."""
+    prefix = "#%05d" % sequence
+
+    if kind == TELEMETRY_TRACE_BOOT and len(payload) >= TRACE_BOOT.size:
+        millis, count = TRACE_BOOT.unpack_from(payload)
+        settings = payload[TRACE_BOOT.size:]
+        if len(settings) != 4 + count:
+            return None
+        power = POWER_NAMES[settings[-1]] if settings[-1] < len(POWER_NAMES) else settings[-1]
+        return "%s %9.3fs  BOOT set %dF %d%% RH solar %d%%  fans %s  power %s" % (
+            prefix, millis / 1000.0, settings[0], settings[1], settings[2],
+            " ".join(str(option) for option in settings[3:-1]), power)
+
+    if kind == TELEMETRY_TRACE_DHT and len(payload) == TRACE_DHT.size:
+        millis, humidity, tenths = TRACE_DHT.unpack(payload)
+        return "%s %9.3fs  DHT %.1fC %d%% RH" % (prefix, millis / 1000.0, tenths / 10.0, humidity)
+
+    if kind == TELEMETRY_TRACE_SOLAR and len(payload) == TRACE_SOLAR.size:
+        millis, reading = TRACE_SOLAR.unpack(payload)
+        return "%s %9.3fs  SOLAR %d" % (prefix, millis / 1000.0, reading)
+
+    if kind == TELEMETRY_TRACE_INPUT and len(payload) == TRACE_INPUT.size:
+        millis, steps, button, passes = TRACE_INPUT.unpack(payload)
+        # Passes that ran tasks before it in the same millisecond
+        after = " after %d" % passes if passes else ""
+        if steps:
+            return "%s %9.3fs  KNOB %+d%s" % (prefix, millis / 1000.0, steps, after)
+        event = BUTTON_EVENTS[button] if button < len(BUTTON_EVENTS) else "event %d" % button
+        return "%s %9.3fs  BUTTON %s%s" % (prefix, millis / 1000.0, event, after)
+
+    if kind == TELEMETRY_TRACE_FANS and len(payload) >= TRACE_FANS.size:
+        millis, count = TRACE_FANS.unpack_from(payload)
+        duties = payload[TRACE_FANS.size:]
+        if len(duties) != count:
+            return None
+        return "%s %9.3fs  FANS %s" % (prefix, millis / 1000.0, " ".join("%3d" % duty for duty in duties))
+
+    return None
+
+
+def open_input(source, baud):
+    if source == "-":
+        return sys.stdin.buffer
+
+    try:
+        import serial
+    except ImportError:
+        # Not a port we can open without pyserial, try it as a capture file
+        return open(source, "rb")
+
+    try:
+        return serial.Serial(source, baud, timeout=0.1)
+    except (serial.SerialException, ValueError):
+        return open(source, "rb")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("source", help="serial port, capture file, or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200, help="serial speed (default 115200)")
+    parser.add_argument("--csv", action="store_true", help="print status frames as CSV")
+    parser.add_argument("--save", metavar="FILE", help="also write the raw bytes to FILE, for native/replay")
+    args = parser.parse_args()
+
+    stream = open_input(args.source, args.baud)
+    decoder = Decoder()
+    save = open(args.save, "wb") if args.save else None
+
+    if args.csv:
+        print("sequence," + ",".join(STATUS_FIELDS))
+
+    try:
+        while True:
+            data = stream.read(256) if hasattr(stream, "in_waiting") else stream.read1(256)
+
+            if not data:
+                # A port just timed out; a file or pipe has ended
+                if hasattr(stream, "in_waiting"):
+                    continue
+                break
+
+            if save:
+                save.write(data)
+
+            for item in decoder.feed(data):
+                if item[0] == "text":
+                    if not args.csv:
+                        print(item[1])
+                elif item[1] == TELEMETRY_STATUS and len(item[3]) == STATUS.size:
+                    status = decode_status(item[3])
+                    if args.csv:
+                        print("%d,%s" % (item[2], ",".join(str(status[field]) for field in STATUS_FIELDS)))
+                    else:
+                        print(format_status(item[2], status))
+                elif not args.csv:
+                    line = format_trace(item[2], item[1], item[3])
+                    if line is None:
+                        line = "#%05d unknown frame type 0x%02X, %d bytes" % (item[2], item[1], len(item[3]))
+                    print(line)
+
+                sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if save:
+            save.close()
+
+    print("%d frames, %d lost, %d CRC errors" % (decoder.frames, decoder.lost, decoder.crc_errors), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()